@@ -0,0 +1,62 @@
+#include "comum.h"
+
+// Custo de manter a lista de avioes acompanhados pelos avisos de impasse: com
+// N avioes ja na lista, cada um pede de novo (entrar na lista, como em todo
+// pedido com passos) e um quarto deles sai do registro e volta (sair e
+// entrar). O custo por operacao nao deve crescer com N.
+// Uso: bench-avisos [avioes ...]   (padrao: 16 1024 16384)
+
+#define RODADAS 20
+
+#ifndef ORDEM_GLOBAL
+static void medir(int num_avioes) {
+    aviao_t* avioes = criar_avioes(num_avioes);
+    for (int i = 0; i < num_avioes; i++) {
+        detector_adicionar_warning(&avioes[i]);
+    }
+
+    long operacoes = 0;
+    double inicio = relogio_real();
+    for (int r = 0; r < RODADAS; r++) {
+        for (int i = 0; i < num_avioes; i++) {
+            detector_adicionar_warning(&avioes[i]);
+            operacoes++;
+        }
+        for (int i = r % 4; i < num_avioes; i += 4) {
+            remover_aviao_warning(&avioes[i]);
+            detector_adicionar_warning(&avioes[i]);
+            operacoes += 2;
+        }
+    }
+    double decorrido = relogio_real() - inicio;
+
+    printf("%7d | %12.1f   %s\n", num_avioes, decorrido * 1e9 / operacoes,
+           num_avioes_warnings == num_avioes ? "ok" : "DIVERGE");
+
+    for (int i = 0; i < num_avioes; i++) {
+        remover_aviao_warning(&avioes[i]);
+    }
+    destruir_avioes(avioes, num_avioes);
+}
+#endif
+
+int main(int argc, char* argv[]) {
+#ifdef ORDEM_GLOBAL
+    (void)argc;
+    (void)argv;
+    printf("Compilado com ORDEM_GLOBAL: nao ha lista de avisos para medir.\n");
+#else
+    relogio_iniciar(false, 1.0);
+    pthread_mutex_init(&mutex_warnings, NULL);
+
+    printf(" avioes | ns/operacao\n");
+    int padrao[] = { 16, 1024, 16384 };
+    int total = argc > 1 ? argc - 1 : 3;
+    for (int i = 0; i < total; i++) {
+        medir(argc > 1 ? atoi(argv[i + 1]) : padrao[i]);
+    }
+
+    pthread_mutex_destroy(&mutex_warnings);
+#endif
+    return 0;
+}
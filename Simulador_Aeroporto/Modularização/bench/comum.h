@@ -0,0 +1,29 @@
+#ifndef BENCH_COMUM_H
+#define BENCH_COMUM_H
+
+#include "aeroporto.h"
+
+// Avioes dos benchmarks, fora do registro: preparados como registros novos,
+// com ID a partir de 1 e slot igual ao indice. Sem memoria, o benchmark sai.
+static inline aviao_t* criar_avioes(int n) {
+    aviao_t* avioes = calloc(n, sizeof(aviao_t));
+    if (avioes == NULL) {
+        perror("Falha ao alocar avioes");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; i++) {
+        aviao_preparar_registro(&avioes[i]);
+        avioes[i].ID = i + 1;
+        avioes[i].slot = i;
+    }
+    return avioes;
+}
+
+static inline void destruir_avioes(aviao_t* avioes, int n) {
+    for (int i = 0; i < n; i++) {
+        aviao_descartar_registro(&avioes[i]);
+    }
+    free(avioes);
+}
+
+#endif
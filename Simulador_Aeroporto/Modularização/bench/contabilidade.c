@@ -0,0 +1,105 @@
+#include "comum.h"
+
+// Custo da contabilidade do detector em cada pedido de recurso: cada thread
+// pede e devolve uma pista, com unidades sobrando para todas, e faz as mesmas
+// chamadas de solicitar_recurso_com_prioridade e liberar_pista. Com passos o
+// detector as registra; com ordenada elas se reduzem a um teste de modo; com
+// banqueiro a operacao e declarada e cada concessao verifica a seguranca.
+// Uso: bench-contabilidade [threads ...]   (padrao: 1 4 16)
+
+#define PEDIDOS_POR_THREAD 200000
+
+static pthread_barrier_t largada;
+
+static void* rotina_pedidos(void* arg) {
+    aviao_t* aviao = arg;
+    pthread_barrier_wait(&largada);
+    for (int i = 0; i < PEDIDOS_POR_THREAD; i++) {
+        banqueiro_declarar(aviao, 1 << RECURSO_PISTA);
+        registrar_requisicao(aviao, RECURSO_PISTA);
+        adicionar_aviao_warning(aviao);
+        recurso_solicitar(&recurso_pistas, aviao);
+        limpar_requisicao(aviao, RECURSO_PISTA);
+        registrar_alocacao(aviao, RECURSO_PISTA);
+
+        registrar_liberacao(aviao, RECURSO_PISTA);
+        banqueiro_liberar(aviao, RECURSO_PISTA);
+        recurso_devolver(&recurso_pistas);
+    }
+    return NULL;
+}
+
+static double medir(tipo_aquisicao aquisicao, int num_threads) {
+    config.aquisicao = aquisicao;
+    NUM_PISTAS = num_threads;
+    config.fila = aquisicao == AQUISICAO_BANQUEIRO ? FILA_LISTA : FILA_HEAP;
+    inicializar_fila(&fila_pistas);
+    inicializar_fila(&fila_portoes);
+    inicializar_fila(&fila_torre_ops);
+    inicializar_recurso(&recurso_pistas, RECURSO_PISTA, &fila_pistas, num_threads);
+    inicializar_recurso(&recurso_portoes, RECURSO_PORTAO, &fila_portoes, 0);
+    inicializar_recurso(&recurso_torre_ops, RECURSO_TORRE, &fila_torre_ops, 0);
+    inicializar_banqueiro(num_threads, 0, 0);
+    inicializar_detector_deadlock();
+    detector_garantir_capacidade(num_threads);
+
+    aviao_t* avioes = criar_avioes(num_threads);
+    pthread_t* threads = malloc(num_threads * sizeof(pthread_t));
+    if (threads == NULL) {
+        perror("Falha ao alocar threads");
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_barrier_init(&largada, NULL, num_threads + 1);
+    for (int i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, rotina_pedidos, &avioes[i]);
+    }
+    pthread_barrier_wait(&largada);
+    double inicio = relogio_real();
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double decorrido = relogio_real() - inicio;
+    pthread_barrier_destroy(&largada);
+
+    for (int i = 0; i < num_threads; i++) {
+        remover_aviao_warning(&avioes[i]);
+    }
+    destruir_detector_deadlock();
+    destruir_banqueiro();
+    destruir_fila(&fila_pistas);
+    destruir_fila(&fila_portoes);
+    destruir_fila(&fila_torre_ops);
+    destruir_avioes(avioes, num_threads);
+    free(threads);
+
+    return decorrido * 1e9 / ((double)num_threads * PEDIDOS_POR_THREAD);
+}
+
+int main(int argc, char* argv[]) {
+    relogio_iniciar(false, 1.0);
+    pthread_mutex_init(&mutex_warnings, NULL);
+    pthread_mutex_init(&mutex_contadores, NULL);
+
+#ifdef ORDEM_GLOBAL
+    printf("Compilado com ORDEM_GLOBAL: a contabilidade nao existe e passos mede o mesmo que ordenada.\n");
+    tipo_aquisicao com_detector = AQUISICAO_ORDENADA;
+#else
+    tipo_aquisicao com_detector = AQUISICAO_PASSOS;
+#endif
+
+    printf("threads |  passos ns/pedido  ordenada ns/pedido  banqueiro ns/pedido\n");
+    int padrao[] = { 1, 4, 16 };
+    int total = argc > 1 ? argc - 1 : 3;
+    for (int i = 0; i < total; i++) {
+        int num_threads = argc > 1 ? atoi(argv[i + 1]) : padrao[i];
+        double passos = medir(com_detector, num_threads);
+        double ordenada = medir(AQUISICAO_ORDENADA, num_threads);
+        double seguro = medir(AQUISICAO_BANQUEIRO, num_threads);
+        printf("%7d | %18.1f %19.1f %20.1f\n", num_threads, passos, ordenada, seguro);
+    }
+
+    pthread_mutex_destroy(&mutex_warnings);
+    pthread_mutex_destroy(&mutex_contadores);
+    return 0;
+}
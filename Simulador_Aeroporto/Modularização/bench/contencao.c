@@ -0,0 +1,81 @@
+#include "comum.h"
+
+// Disputa por uma unica fila: cada thread retira o cabeca e o reinsere, como
+// um recurso muito disputado em que todo mundo entra e sai da fila o tempo
+// todo. A lista ordenada serializa tudo em fila->mutex; a skiplist nao trava.
+// Uso: bench-contencao [threads ...]   (padrao: 8 32 64)
+
+#define AVIOES_POR_THREAD 16
+#define OPERACOES_POR_THREAD 20000
+
+static pthread_barrier_t largada;
+
+static void* rotina_disputa(void* arg) {
+    (void)arg;
+    pthread_barrier_wait(&largada);
+    for (int i = 0; i < OPERACOES_POR_THREAD; i++) {
+        request_node_t* no = fila_retirar_cabeca(&fila_pistas);
+        if (no != NULL) {
+            adicionar_requisicao(&fila_pistas, no->aviao, RECURSO_PISTA);
+        }
+    }
+    return NULL;
+}
+
+static void medir(tipo_fila tipo, int num_threads) {
+    config.fila = tipo;
+    inicializar_fila(&fila_pistas);
+
+    int n = num_threads * AVIOES_POR_THREAD;
+    aviao_t* avioes = criar_avioes(n);
+    pthread_t* threads = malloc(num_threads * sizeof(pthread_t));
+    if (threads == NULL) {
+        perror("Falha ao alocar threads");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; i++) {
+        avioes[i].tipo = i % 2 ? INTERNACIONAL : DOMESTICO;
+        adicionar_requisicao(&fila_pistas, &avioes[i], RECURSO_PISTA);
+    }
+
+    pthread_barrier_init(&largada, NULL, num_threads + 1);
+    for (int i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, rotina_disputa, NULL);
+    }
+    pthread_barrier_wait(&largada);
+    double inicio = relogio_real();
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double decorrido = relogio_real() - inicio;
+    pthread_barrier_destroy(&largada);
+
+    // Nenhum no pode ter sumido ou entrado duas vezes.
+    int restantes = 0;
+    while (fila_retirar_cabeca(&fila_pistas) != NULL) restantes++;
+
+    static const char* NOMES[] = { "lista", "heap", "baldes", "skiplist" };
+    double operacoes = 2.0 * num_threads * OPERACOES_POR_THREAD;
+    printf("%-8s %7d | %10.1f %12.0f   %s\n", NOMES[tipo], num_threads,
+           decorrido * 1e3, operacoes / decorrido, restantes == n ? "ok" : "PERDEU NOS");
+
+    destruir_fila(&fila_pistas);
+    destruir_avioes(avioes, n);
+    free(threads);
+}
+
+int main(int argc, char* argv[]) {
+    relogio_iniciar(false, 1.0);
+    config.envelhecimento = ENVELHECIMENTO_LINEAR;    // o da skiplist
+
+    printf("fila     threads |    total ms      ops/s\n");
+    int padrao[] = { 8, 32, 64 };
+    int total = argc > 1 ? argc - 1 : 3;
+    for (int i = 0; i < total; i++) {
+        int num_threads = argc > 1 ? atoi(argv[i + 1]) : padrao[i];
+        medir(FILA_LISTA, num_threads);
+        medir(FILA_SKIPLIST, num_threads);
+    }
+    skiplist_liberar_memoria();
+    return 0;
+}
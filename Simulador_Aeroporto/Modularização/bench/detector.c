@@ -0,0 +1,84 @@
+#include "aeroporto.h"
+
+// Varredura de "segura e espera" sobre a tabela inteira do detector: o kernel
+// de bitsets (detector_contar_retencao_espera) contra o laco por slot sobre
+// matrizes int[3] com desvios, como era antes.
+// Uso: bench-detector [slots ...]   (padrao: 1024 65536 1048576)
+
+#define VARREDURAS 200
+
+#ifndef ORDEM_GLOBAL
+static int contar_matrizes(int (*alocacao)[3], int (*requisicao)[3], int slots) {
+    int total = 0;
+    for (int i = 0; i < slots; i++) {
+        bool esperando = false, tem_recursos = false;
+        for (int j = 0; j < 3; j++) {
+            if (requisicao[i][j] > 0) esperando = true;
+            if (alocacao[i][j] > 0) tem_recursos = true;
+        }
+        if (esperando && tem_recursos) total++;
+    }
+    return total;
+}
+
+static void medir(int slots) {
+    inicializar_detector_deadlock();
+    detector_garantir_capacidade(slots);
+
+    int (*alocacao)[3] = calloc(slots, sizeof(*alocacao));
+    int (*requisicao)[3] = calloc(slots, sizeof(*requisicao));
+    if (alocacao == NULL || requisicao == NULL) {
+        perror("Falha ao alocar matrizes");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < slots; i++) {
+        for (int r = 0; r < 3; r++) {
+            if (rand() % 4 == 0) {
+                alocacao[i][r] = 1;
+                detector.grafo.posse[r][i >> 6] |= 1ULL << (i & 63);
+            }
+        }
+        if (rand() % 8 == 0) {
+            int r = rand() % 3;
+            requisicao[i][r] = 1;
+            detector.grafo.espera[r][i >> 6] |= 1ULL << (i & 63);
+        }
+    }
+
+    volatile int resultado = 0;
+    double inicio = relogio_real();
+    for (int i = 0; i < VARREDURAS; i++) resultado = contar_matrizes(alocacao, requisicao, slots);
+    double matrizes = (relogio_real() - inicio) / VARREDURAS;
+    int esperado = resultado;
+
+    inicio = relogio_real();
+    for (int i = 0; i < VARREDURAS; i++) resultado = detector_contar_retencao_espera();
+    double bitsets = (relogio_real() - inicio) / VARREDURAS;
+
+    printf("%9d | %12.2f %12.2f %8.1fx   %s\n", slots, matrizes * 1e6, bitsets * 1e6, matrizes / bitsets,
+           resultado == esperado ? "ok" : "DIVERGE");
+
+    free(alocacao);
+    free(requisicao);
+    destruir_detector_deadlock();
+}
+#endif
+
+int main(int argc, char* argv[]) {
+#ifdef ORDEM_GLOBAL
+    (void)argc;
+    (void)argv;
+    printf("Compilado com ORDEM_GLOBAL: nao ha detector para medir.\n");
+#else
+    relogio_iniciar(false, 1.0);
+    srand(1);
+
+    printf("    slots | matrizes us  bitsets us  ganho\n");
+    int padrao[] = { 1024, 65536, 1048576 };
+    int total = argc > 1 ? argc - 1 : 3;
+    for (int i = 0; i < total; i++) {
+        medir(argc > 1 ? atoi(argv[i + 1]) : padrao[i]);
+    }
+#endif
+    return 0;
+}
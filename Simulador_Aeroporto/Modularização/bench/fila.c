@@ -0,0 +1,83 @@
+#include "comum.h"
+
+// Compara as implementacoes de fila_prioridade_t com N avioes esperando:
+// insercao, atendimento da cabeca com reinsercao, mudanca de prioridade e
+// remocao de quem desistiu. Com o envelhecimento linear ele esta na chave e
+// nao aparece.
+// Uso: bench-fila [N ...]   (padrao: 100 1000 10000)
+
+static double cronometrar(double* inicio) {
+    double agora = relogio_real();
+    double decorrido = agora - *inicio;
+    *inicio = agora;
+    return decorrido * 1e3;
+}
+
+static void medir(tipo_fila tipo, int n) {
+    config.fila = tipo;
+    inicializar_fila(&fila_pistas);
+
+    aviao_t* avioes = criar_avioes(n);
+    srand(42);
+    for (int i = 0; i < n; i++) {
+        avioes[i].tipo = rand() % 2 ? INTERNACIONAL : DOMESTICO;
+        avioes[i].recursos_realocados = rand() % 10 == 0;
+    }
+
+    double inicio = relogio_real();
+
+    for (int i = 0; i < n; i++) {
+        adicionar_requisicao(&fila_pistas, &avioes[i], RECURSO_PISTA);
+    }
+    double t_inserir = cronometrar(&inicio);
+
+    for (int i = 0; i < n; i++) {
+        pthread_mutex_lock(&fila_pistas.mutex);
+        aviao_t* cabeca = fila_cabeca(&fila_pistas)->aviao;
+        remover_requisicao_travada(&fila_pistas, cabeca);
+        pthread_mutex_unlock(&fila_pistas.mutex);
+        adicionar_requisicao(&fila_pistas, cabeca, RECURSO_PISTA);
+    }
+    double t_atender = cronometrar(&inicio);
+
+    for (int i = 0; i < n; i++) {
+        request_node_t* no = &avioes[rand() % n].requisicoes[RECURSO_PISTA];
+        pthread_mutex_lock(&fila_pistas.mutex);
+        fila_reprioritizar(&fila_pistas, no, no->chave + rand() % 20);
+        pthread_mutex_unlock(&fila_pistas.mutex);
+    }
+    double t_reprioritizar = cronometrar(&inicio);
+
+    for (int i = 0; i < n; i++) {
+        remover_requisicao(&fila_pistas, &avioes[rand() % n]);
+    }
+    for (int i = 0; i < n; i++) {
+        remover_requisicao(&fila_pistas, &avioes[i]);
+    }
+    double t_remover = cronometrar(&inicio);
+
+    static const char* NOMES[] = { "lista", "heap", "baldes", "skiplist" };
+    printf("%-8s %7d | %10.2f %10.2f %10.2f %10.2f\n", NOMES[tipo], n,
+           t_inserir, t_atender, t_reprioritizar, t_remover);
+
+    destruir_fila(&fila_pistas);
+    destruir_avioes(avioes, n);
+}
+
+int main(int argc, char* argv[]) {
+    relogio_iniciar(true, 1.0);
+    config.envelhecimento = ENVELHECIMENTO_LINEAR;
+
+    printf("fila      avioes |  inserir ms  atender ms reprior. ms  remover ms\n");
+    int padrao[] = { 100, 1000, 10000 };
+    int total = argc > 1 ? argc - 1 : 3;
+    for (int i = 0; i < total; i++) {
+        int n = argc > 1 ? atoi(argv[i + 1]) : padrao[i];
+        medir(FILA_LISTA, n);
+        medir(FILA_HEAP, n);
+        medir(FILA_BALDES, n);
+        medir(FILA_SKIPLIST, n);
+    }
+    skiplist_liberar_memoria();
+    return 0;
+}
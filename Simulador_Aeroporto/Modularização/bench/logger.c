@@ -0,0 +1,120 @@
+#include "aeroporto.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+// Custo de log_evento para quem registra, com o stdout e o arquivo em
+// /dev/null: cada thread registra MENSAGENS_POR_THREAD mensagens do tamanho
+// das do simulador. "produtor" e o tempo ate a ultima thread terminar;
+// "total" inclui log_close, que espera a escritora gravar o que sobrou. As
+// colunas de bloquear variam as saidas: arquivo e console (o padrao), so o
+// arquivo, nenhuma e o arquivo binario, o unico que nao formata; descartar e
+// sobrescrever usam as saidas padrao. Por fim, uma
+// thread so com o anel grande o bastante para nunca encher nem acordar a
+// escritora mede o que a mensagem custa para quem registra, e o que custa com
+// a categoria desligada em tempo de execucao.
+// Uso: bench-logger [threads ...]   (padrao: 1 4 16)
+
+#define MENSAGENS_POR_THREAD 100000
+
+static pthread_barrier_t largada;
+
+static void* rotina_mensagens(void* arg) {
+    int id = (int)(long)arg;
+    pthread_barrier_wait(&largada);
+    for (int i = 0; i < MENSAGENS_POR_THREAD; i++) {
+        log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] alocou Pista apos %.2fs de espera (prioridade %d).\n",
+               id, i * 0.01, i % 100);
+    }
+    return NULL;
+}
+
+static void medir(politica_log_cheio politica, bool binario, int saidas, size_t capacidade, int num_threads,
+                  double* produtor, double* total) {
+    log_init("/dev/null", "/dev/null", capacidade, politica, binario, saidas);
+
+    pthread_t* threads = malloc(num_threads * sizeof(pthread_t));
+    if (threads == NULL) {
+        perror("Falha ao alocar threads");
+        exit(EXIT_FAILURE);
+    }
+    pthread_barrier_init(&largada, NULL, num_threads + 1);
+    for (int i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, rotina_mensagens, (void*)(long)(i + 1));
+    }
+    // Com um nucleo as threads podem acabar antes de main voltar da barreira.
+    double inicio = relogio_real();
+    pthread_barrier_wait(&largada);
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double fim_produtores = relogio_real();
+    log_close();
+    double fim = relogio_real();
+    pthread_barrier_destroy(&largada);
+    free(threads);
+
+    double mensagens = (double)num_threads * MENSAGENS_POR_THREAD;
+    *produtor = (fim_produtores - inicio) * 1e9 / mensagens;
+    *total = (fim - inicio) * 1e9 / mensagens;
+}
+
+int main(int argc, char* argv[]) {
+    relogio_iniciar(false, 1.0);
+
+    printf("        | bloquear ns/msg (total), por saidas\n");
+    printf("threads | %-15s %-15s %-15s %-15s %24s %28s\n", "arquivo+console", "so arquivo", "nulo", "binario",
+           "descartar ns/msg (total)", "sobrescrever ns/msg (total)");
+    fflush(stdout);
+    int saida = dup(STDOUT_FILENO);
+    int erros = dup(STDERR_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+
+    int padrao[] = { 1, 4, 16 };
+    int total = argc > 1 ? argc - 1 : 3;
+    for (int i = 0; i < total; i++) {
+        int num_threads = argc > 1 ? atoi(argv[i + 1]) : padrao[i];
+        double produtor[6], tudo[6];
+
+        dup2(nulo, STDOUT_FILENO);
+        dup2(nulo, STDERR_FILENO);
+        medir(LOG_CHEIO_BLOQUEAR, false, SAIDAS_LOG_PADRAO, CAPACIDADE_LOG_PADRAO, num_threads, &produtor[0],
+              &tudo[0]);
+        medir(LOG_CHEIO_BLOQUEAR, false, SAIDA_LOG_ARQUIVO, CAPACIDADE_LOG_PADRAO, num_threads, &produtor[1],
+              &tudo[1]);
+        medir(LOG_CHEIO_BLOQUEAR, false, 0, CAPACIDADE_LOG_PADRAO, num_threads, &produtor[2], &tudo[2]);
+        medir(LOG_CHEIO_BLOQUEAR, true, SAIDA_LOG_ARQUIVO, CAPACIDADE_LOG_PADRAO, num_threads, &produtor[3],
+              &tudo[3]);
+        medir(LOG_CHEIO_DESCARTAR, false, SAIDAS_LOG_PADRAO, CAPACIDADE_LOG_PADRAO, num_threads, &produtor[4],
+              &tudo[4]);
+        medir(LOG_CHEIO_SOBRESCREVER, false, SAIDAS_LOG_PADRAO, CAPACIDADE_LOG_PADRAO, num_threads,
+              &produtor[5], &tudo[5]);
+        fflush(stdout);
+        dup2(saida, STDOUT_FILENO);
+        dup2(erros, STDERR_FILENO);
+
+        printf("%7d | %6.1f %8.1f %6.1f %8.1f %6.1f %8.1f %6.1f %8.1f %15.1f %8.1f %19.1f %8.1f\n", num_threads,
+               produtor[0], tudo[0], produtor[1], tudo[1], produtor[2], tudo[2], produtor[3], tudo[3],
+               produtor[4], tudo[4], produtor[5], tudo[5]);
+        fflush(stdout);
+    }
+
+    double produtor, tudo;
+    dup2(nulo, STDOUT_FILENO);
+    medir(LOG_CHEIO_BLOQUEAR, false, SAIDAS_LOG_PADRAO, 4 * MENSAGENS_POR_THREAD, 1, &produtor, &tudo);
+    fflush(stdout);
+    dup2(saida, STDOUT_FILENO);
+    printf("sem espera pela escritora: %.1f ns/msg\n", produtor);
+    fflush(stdout);
+
+    log_niveis[LOG_RECURSO] = NIVEL_AVISO;
+    dup2(nulo, STDOUT_FILENO);
+    medir(LOG_CHEIO_BLOQUEAR, false, SAIDAS_LOG_PADRAO, CAPACIDADE_LOG_PADRAO, 1, &produtor, &tudo);
+    fflush(stdout);
+    dup2(saida, STDOUT_FILENO);
+    printf("categoria desligada: %.1f ns/msg\n", produtor);
+
+    close(saida);
+    close(erros);
+    close(nulo);
+    return 0;
+}
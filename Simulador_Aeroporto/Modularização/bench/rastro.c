@@ -0,0 +1,78 @@
+#include "aeroporto.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+// Custo de um evento no rastro para quem registra e o tamanho medio dele no
+// arquivo: cada thread registra EVENTOS_POR_THREAD pedidos, concessoes e
+// liberacoes de avioes e recursos variados. Por fim, o custo do ponto de
+// registro com o rastro desligado.
+// Uso: bench-rastro [threads ...]   (padrao: 1 4 16)
+
+#define EVENTOS_POR_THREAD 200000
+#define ARQUIVO_BENCH "/tmp/bench-rastro.rastro"
+
+static pthread_barrier_t largada;
+
+static void* rotina_eventos(void* arg) {
+    int id = (int)(long)arg;
+    pthread_barrier_wait(&largada);
+    for (int i = 0; i < EVENTOS_POR_THREAD; i++) {
+        rastro_evento((tipo_evento_rastro)(i % 3), id * 1000 + i % 1000, i % 3, PRIORIDADE_BASE_DOMESTICO, 0);
+    }
+    return NULL;
+}
+
+static double medir(int num_threads) {
+    pthread_t* threads = malloc(num_threads * sizeof(pthread_t));
+    if (threads == NULL) {
+        perror("Falha ao alocar threads");
+        exit(EXIT_FAILURE);
+    }
+    pthread_barrier_init(&largada, NULL, num_threads + 1);
+    for (int i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, rotina_eventos, (void*)(long)(i + 1));
+    }
+    // Com um nucleo as threads podem acabar antes de main voltar da barreira.
+    double inicio = relogio_real();
+    pthread_barrier_wait(&largada);
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double decorrido = relogio_real() - inicio;
+    pthread_barrier_destroy(&largada);
+    free(threads);
+    return decorrido * 1e9 / ((double)num_threads * EVENTOS_POR_THREAD);
+}
+
+int main(int argc, char* argv[]) {
+    relogio_iniciar(false, 1.0);
+
+    printf("threads | ns/evento  bytes/evento\n");
+    fflush(stdout);
+    int saida = dup(STDOUT_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+    int padrao[] = { 1, 4, 16 };
+    int total = argc > 1 ? argc - 1 : 3;
+    for (int i = 0; i < total; i++) {
+        int num_threads = argc > 1 ? atoi(argv[i + 1]) : padrao[i];
+        rastro_iniciar(ARQUIVO_BENCH);
+        double custo = medir(num_threads);
+        dup2(nulo, STDOUT_FILENO);
+        rastro_encerrar();
+        fflush(stdout);
+        dup2(saida, STDOUT_FILENO);
+
+        FILE* arquivo = fopen(ARQUIVO_BENCH, "rb");
+        fseek(arquivo, 0, SEEK_END);
+        long tamanho = ftell(arquivo);
+        fclose(arquivo);
+        printf("%7d | %9.1f  %12.2f\n", num_threads, custo, (double)tamanho / ((double)num_threads * EVENTOS_POR_THREAD));
+        fflush(stdout);
+    }
+    printf("rastro desligado: %.1f ns/evento\n", medir(1));
+
+    unlink(ARQUIVO_BENCH);
+    close(saida);
+    close(nulo);
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include "comum.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+// Quanto a verificacao periodica segura detector.mutex, que todo registro de
+// alocacao e liberacao precisa: metade dos avioes segura uma pista e aguarda
+// um portao, a outra metade o contrario, todos em impasse e pendentes. Cada
+// verificacao revalida todos eles.
+// Uso: bench-verificacao [avioes ...]   (padrao: 1024 4096 16384)
+
+#define VERIFICACOES 10
+
+#ifndef ORDEM_GLOBAL
+static void medir(int num_avioes) {
+    int metade = num_avioes / 2;
+    NUM_PISTAS = metade;
+    NUM_PORTOES = num_avioes - metade;
+    NUM_OP_TORRES = 1;
+    inicializar_detector_deadlock();
+    detector_garantir_capacidade(num_avioes);
+
+    aviao_t* avioes = criar_avioes(num_avioes);
+
+    // Os registros e as verificacoes escrevem no log a cada impasse.
+    fflush(stdout);
+    int saida = dup(STDOUT_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+    dup2(nulo, STDOUT_FILENO);
+
+    for (int i = 0; i < num_avioes; i++) {
+        registrar_alocacao(&avioes[i], i < metade ? RECURSO_PISTA : RECURSO_PORTAO);
+    }
+    for (int i = 0; i < num_avioes; i++) {
+        registrar_requisicao(&avioes[i], i < metade ? RECURSO_PORTAO : RECURSO_PISTA);
+    }
+
+    // Um registro entre verificacoes obriga a copiar o grafo de novo.
+    double inicio = relogio_real();
+    for (int i = 0; i < VERIFICACOES; i++) {
+        registrar_liberacao(&avioes[0], RECURSO_PISTA);
+        registrar_alocacao(&avioes[0], RECURSO_PISTA);
+        verificar_deadlock();
+    }
+    double verificacao = (relogio_real() - inicio) / VERIFICACOES;
+
+    fflush(stdout);
+    dup2(saida, STDOUT_FILENO);
+    close(saida);
+    close(nulo);
+
+    printf("%7d | %15.2f %17.1f\n", num_avioes, verificacao * 1e3, detector.retrato.maior_trava * 1e6);
+
+    destruir_detector_deadlock();
+    destruir_avioes(avioes, num_avioes);
+}
+#endif
+
+int main(int argc, char* argv[]) {
+#ifdef ORDEM_GLOBAL
+    (void)argc;
+    (void)argv;
+    printf("Compilado com ORDEM_GLOBAL: nao ha detector para medir.\n");
+#else
+    relogio_iniciar(false, 1.0);
+    pthread_mutex_init(&mutex_warnings, NULL);
+    pthread_mutex_init(&mutex_contadores, NULL);
+
+    printf(" avioes | verificacao ms  maior trava us\n");
+    int padrao[] = { 1024, 4096, 16384 };
+    int total = argc > 1 ? argc - 1 : 3;
+    for (int i = 0; i < total; i++) {
+        medir(argc > 1 ? atoi(argv[i + 1]) : padrao[i]);
+    }
+
+    pthread_mutex_destroy(&mutex_warnings);
+    pthread_mutex_destroy(&mutex_contadores);
+#endif
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "logger.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+// Reconstroi o log em texto a partir do simulacao.bin gravado com
+// --log-binario: o mesmo arquivo que o modo texto teria escrito.
+// Uso: decodificar_log [entrada.bin] [saida.log]
+//      (padrao: simulacao.bin simulacao.log; "-" como saida e o stdout)
+
+static char* formatos[MAX_FORMATOS_LOG];
+
+static int ler(FILE* entrada, void* destino, size_t tamanho) {
+    return fread(destino, 1, tamanho, entrada) == tamanho ? 0 : -1;
+}
+
+static int corrompido(const char* caminho) {
+    fprintf(stderr, "Arquivo de log binario corrompido: %s\n", caminho);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    const char* caminho_entrada = argc > 1 ? argv[1] : "simulacao.bin";
+    const char* caminho_saida = argc > 2 ? argv[2] : "simulacao.log";
+
+    FILE* entrada = fopen(caminho_entrada, "rb");
+    if (entrada == NULL) {
+        perror("Falha ao abrir o log binario");
+        return 1;
+    }
+    char magico[sizeof(MAGICO_LOG_BINARIO) - 1];
+    if (ler(entrada, magico, sizeof(magico)) == -1 || memcmp(magico, MAGICO_LOG_BINARIO, sizeof(magico)) != 0) {
+        fprintf(stderr, "Nao e um log binario do simulador: %s\n", caminho_entrada);
+        return 1;
+    }
+    FILE* saida = strcmp(caminho_saida, "-") == 0 ? stdout : fopen(caminho_saida, "w");
+    if (saida == NULL) {
+        perror("Falha ao abrir o log de saida");
+        return 1;
+    }
+
+    fprintf(saida, "--- Log da Simulação do Aeroporto ---\n");
+    unsigned long mensagens = 0;
+    time_t ultima_data = (time_t)-1;
+    char time_buf[32] = "";
+    unsigned char argumentos[UINT16_MAX];
+    char texto[UINT16_MAX + 1];
+    int marca;
+    while ((marca = fgetc(entrada)) != EOF) {
+        uint16_t cabecalho[2];
+        if (marca == LOG_BIN_FORMATO) {
+            if (ler(entrada, cabecalho, sizeof(cabecalho)) == -1 || cabecalho[0] >= MAX_FORMATOS_LOG) {
+                return corrompido(caminho_entrada);
+            }
+            char* formato = malloc(cabecalho[1] + 1);
+            if (formato == NULL || ler(entrada, formato, cabecalho[1]) == -1) return corrompido(caminho_entrada);
+            formato[cabecalho[1]] = '\0';
+            free(formatos[cabecalho[0]]);
+            formatos[cabecalho[0]] = formato;
+        } else if (marca == LOG_BIN_MENSAGEM) {
+            int64_t data;
+            if (ler(entrada, cabecalho, sizeof(cabecalho)) == -1 || ler(entrada, &data, sizeof(data)) == -1 ||
+                ler(entrada, argumentos, cabecalho[1]) == -1 || cabecalho[0] >= MAX_FORMATOS_LOG ||
+                formatos[cabecalho[0]] == NULL) {
+                return corrompido(caminho_entrada);
+            }
+            if ((time_t)data != ultima_data) {
+                ultima_data = (time_t)data;
+                struct tm t;
+                localtime_r(&ultima_data, &t);
+                strftime(time_buf, sizeof(time_buf) - 1, "%Y-%m-%d %H:%M:%S", &t);
+            }
+            log_formatar(formatos[cabecalho[0]], argumentos, cabecalho[1], texto, sizeof(texto));
+            fprintf(saida, "[%s] %s", time_buf, texto);
+            mensagens++;
+        } else if (marca == LOG_BIN_TEXTO) {
+            if (ler(entrada, cabecalho, sizeof(uint16_t)) == -1 || ler(entrada, texto, cabecalho[0]) == -1) {
+                return corrompido(caminho_entrada);
+            }
+            fwrite(texto, 1, cabecalho[0], saida);
+        } else {
+            return corrompido(caminho_entrada);
+        }
+    }
+    fprintf(saida, "\n--- Fim do Log ---\n");
+
+    fclose(entrada);
+    if (saida != stdout) fclose(saida);
+    for (int i = 0; i < MAX_FORMATOS_LOG; i++) free(formatos[i]);
+    fprintf(stderr, "%lu mensagens decodificadas de %s.\n", mensagens, caminho_entrada);
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "aeroporto.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Le o simulacao.rastro gravado com --rastro e escreve um evento por linha em
+// CSV: tempo simulado em segundos, evento, aviao, recurso, prioridade e valor.
+// O arquivo inteiro e mapeado; cada segmento se decodifica sozinho.
+// Uso: ler_rastro [entrada.rastro] [saida.csv]
+//      (padrao: simulacao.rastro e o stdout, tambem escolhido com "-")
+
+static int corrompido(const char* caminho, unsigned long segmento) {
+    fprintf(stderr, "Rastro corrompido: %s, segmento %lu\n", caminho, segmento);
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    const char* caminho_entrada = argc > 1 ? argv[1] : "simulacao.rastro";
+    const char* caminho_saida = argc > 2 ? argv[2] : "-";
+
+    int descritor = open(caminho_entrada, O_RDONLY);
+    struct stat info;
+    if (descritor == -1 || fstat(descritor, &info) == -1) {
+        perror("Falha ao abrir o rastro");
+        return 1;
+    }
+    size_t tamanho = (size_t)info.st_size;
+    if (tamanho < sizeof(cabecalho_segmento_rastro_t)) {
+        fprintf(stderr, "Nao e um rastro do simulador: %s\n", caminho_entrada);
+        return 1;
+    }
+    const unsigned char* dados = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, descritor, 0);
+    if (dados == MAP_FAILED) {
+        perror("Falha ao mapear o rastro");
+        return 1;
+    }
+    FILE* saida = strcmp(caminho_saida, "-") == 0 ? stdout : fopen(caminho_saida, "w");
+    if (saida == NULL) {
+        perror("Falha ao abrir a saida");
+        return 1;
+    }
+
+    fprintf(saida, "tempo,evento,aviao,recurso,prioridade,valor\n");
+    unsigned long segmentos = 0, eventos = 0;
+    unsigned long por_tipo[NUM_TIPOS_RASTRO] = { 0 };
+    for (size_t inicio = 0; inicio < tamanho; inicio += TAMANHO_SEGMENTO_RASTRO, segmentos++) {
+        cabecalho_segmento_rastro_t cabecalho;
+        size_t disponivel = tamanho - inicio;
+        if (disponivel < sizeof(cabecalho)) return corrompido(caminho_entrada, segmentos);
+        memcpy(&cabecalho, dados + inicio, sizeof(cabecalho));
+        if (memcmp(cabecalho.magico, MAGICO_RASTRO, sizeof(cabecalho.magico)) != 0 ||
+            sizeof(cabecalho) + cabecalho.bytes > disponivel) {
+            return corrompido(caminho_entrada, segmentos);
+        }
+
+        const unsigned char* p = dados + inicio + sizeof(cabecalho);
+        size_t resto = cabecalho.bytes;
+        int64_t tempo = cabecalho.tempo_base_ns;
+        for (uint32_t i = 0; i < cabecalho.eventos; i++) {
+            evento_rastro_t evento;
+            size_t lidos = rastro_decodificar(p, resto, &tempo, &evento);
+            if (lidos == 0) return corrompido(caminho_entrada, segmentos);
+            p += lidos;
+            resto -= lidos;
+
+            const char* recurso = evento.recurso < 3 ? nome_do_recurso((tipo_recurso)evento.recurso) : "";
+            fprintf(saida, "%.9f,%s,%d,%s,%d,%d\n", evento.tempo_ns / 1e9, NOMES_EVENTOS_RASTRO[evento.tipo],
+                    evento.aviao, recurso, evento.prioridade, evento.valor);
+            por_tipo[evento.tipo]++;
+            eventos++;
+        }
+    }
+
+    if (saida != stdout) fclose(saida);
+    munmap((void*)dados, tamanho);
+    close(descritor);
+
+    fprintf(stderr, "%lu eventos em %lu segmentos de %s:", eventos, segmentos, caminho_entrada);
+    for (int i = 0; i < NUM_TIPOS_RASTRO; i++) {
+        fprintf(stderr, "%s %s %lu", i ? "," : "", NOMES_EVENTOS_RASTRO[i], por_tipo[i]);
+    }
+    fprintf(stderr, ".\n");
+    return 0;
+}
@@ -2,7 +2,6 @@
 #define AEROPORTO_H
 
 #include <pthread.h>
-#include <semaphore.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
@@ -10,7 +9,13 @@
 #include <time.h>
 #include <string.h>
 #include <errno.h>
+#include <stdatomic.h>
 #include "logger.h"
+#include "relogio.h"
+#include "fibra.h"
+#include "temporizador.h"
+#include "skiplist.h"
+#include "rastro.h"
 
 // ---- DEFINIÇÃO DE TEMPOS -----
 extern int TEMPO_TOTAL;
@@ -24,25 +29,49 @@ extern int NUM_TORRES;
 extern int NUM_OP_TORRES;
 
 // ------------ DEFINES ------------
-#define MAX_AVIOES 200
 #define PRIORIDADE_BASE_DOMESTICO   8
 #define PRIORIDADE_BASE_INTERNACIONAL 13
-#define AGING_INCREMENT 1
-#define AGING_INTERVAL 5
+#define PRIORIDADE_BASE_EMERGENCIA  55
+#define PRIORIDADE_BASE_MEDICO      45
+#define PRIORIDADE_BASE_CARGA       5
+#define PRIORIDADE_BASE_AVIACAO_GERAL 3
+#define PRIORIDADE_REALOCADO 50
+#define NUM_BALDES 64
 #define MAX_DEADLOCK_WARNINGS 3
 
 // -------------- STRUCTS --------------
 typedef enum {
     DOMESTICO,
-    INTERNACIONAL
+    INTERNACIONAL,
+    EMERGENCIA,
+    MEDICO,
+    CARGA,
+    AVIACAO_GERAL,
+    NUM_CLASSES_VOO
 } tipo_de_voo;
 
+// Parametros de cada classe de voo; ajustaveis com --classe. A rota diz qual
+// ordem de aquisicao de ORDEM_RECURSOS a classe segue (DOMESTICO ou INTERNACIONAL).
+typedef struct {
+    const char* nome;
+    int prioridade_base;
+    double taxa_envelhecimento; // -1 = config.taxa_envelhecimento
+    int peso;                   // participacao nas chegadas
+    tipo_de_voo rota;
+} classe_voo_t;
+
 typedef enum {
     RECURSO_PISTA,
     RECURSO_PORTAO,
     RECURSO_TORRE
 } tipo_recurso;
 
+typedef enum {
+    OP_POUSO,
+    OP_DESEMBARQUE,
+    OP_DECOLAGEM
+} tipo_operacao;
+
 typedef enum {
     VOANDO,
     POUSANDO,
@@ -53,66 +82,289 @@ typedef enum {
     FALHA_OPERACIONAL
 } estado_aviao;
 
-typedef struct {
-    int ID;
+// No de requisicao embutido no aviao, um por tipo de recurso: entrar e sair
+// de uma fila nao aloca nada.
+typedef struct request_node {
+    struct aviao* aviao;
+    tipo_recurso recurso_desejado;
+    double tempo_chegada;
+    int prioridade_base;
+    double taxa;                // envelhecimento da classe do aviao
+    double chave;               // linear: base - taxa * chegada (+ bonus), fixa na espera;
+                                // degraus: prioridade no segundo em que a fila foi ordenada
+    espera_t espera;
+    bool atendido;              // recebeu a unidade por repasse
+    bool preemptado;            // tirado da fila como vitima de um impasse
+    double concedido_em;        // relogio_real do repasse
+    int prazos_disparados;      // marcos da espera ja vencidos (threads e fibras)
+    bool bonus_aplicado;
+    bool na_fila;
+    unsigned long ordem;        // desempate por chegada
+    int indice;                 // posicao no heap da fila
+    int balde;                  // FILA_BALDES
+    torre_t* torre;             // FILA_SKIPLIST
+    int recursos;               // pedido de conjunto: um bit por tipo_recurso (0 = uma unidade)
+    struct request_node* next;
+    struct request_node* prev;  // FILA_BALDES
+} request_node_t;
+
+typedef struct aviao {
+    _Atomic int ID;                         // muda quando o registro e reciclado
+    int slot;
     tipo_de_voo tipo;
+    tipo_de_voo rota;
     pthread_t thread_id;
     bool em_alerta;
-    time_t tempo_de_criacao;
+    double tempo_de_criacao;
     estado_aviao estado;
     int recursos_alocados[3];
     int deadlock_warnings;
     bool recursos_realocados;
+    int posicao_warning;        // indice em avioes_com_warnings, -1 = fora
+    _Atomic(struct aviao*) herdeiros[3];    // vitima de impasse: quem do impasse recebe cada recurso devolvido
+    int ids_herdeiros[3];
+    request_node_t requisicoes[3];
+    request_node_t pedido_conjunto;     // --aquisicao=conjunto
+    int reivindicacao;          // --aquisicao=banqueiro: recursos da operacao ainda a usar
+    int obtidos;                //   e os que ja segura, um bit por tipo_recurso
 } aviao_t;
 
-typedef struct request_node {
-    aviao_t* aviao;
-    tipo_recurso recurso_desejado;
-    time_t tempo_chegada;
-    int prioridade_atual;
-    pthread_cond_t cond_var;
-    bool atendido;
-    struct request_node* next;
-} request_node_t;
+typedef enum {
+    FILA_LISTA,
+    FILA_HEAP,
+    FILA_BALDES,
+    FILA_SKIPLIST
+} tipo_fila;
+
+typedef enum {
+    ENVELHECIMENTO_DEGRAUS,     // a curva original, reavaliada a cada segundo
+    ENVELHECIMENTO_LINEAR       // taxa constante, chave fixa na espera
+} tipo_envelhecimento;
 
 typedef struct {
-    request_node_t* head;
+    tipo_fila tipo;
+    request_node_t* head;       // FILA_LISTA
+    request_node_t** heap;      // FILA_HEAP
+    request_node_t* baldes[2 * NUM_BALDES];     // FILA_BALDES: FIFO por nivel, sem e com bonus
+    request_node_t* fim_baldes[2 * NUM_BALDES];
+    unsigned long long baldes_ocupados[2];      // bit i do banco k: baldes[k * NUM_BALDES + i] nao vazio
+    skiplist_t skiplist;        // FILA_SKIPLIST
+    int capacidade;
+    long segundo;               // degraus: lista e heap ordenados pelas prioridades deste segundo
+    _Atomic unsigned long proxima_ordem;
     pthread_mutex_t mutex;
     int total_requisicoes;
 } fila_prioridade_t;
 
+// Recurso com repasse direto: as unidades livres ficam sob o mutex da fila e
+// quem libera entrega a unidade ao cabeca da fila.
+typedef struct {
+    tipo_recurso tipo;
+    fila_prioridade_t* fila;
+    int livres;
+    int unidades;
+    unsigned long concessoes_imediatas;
+    unsigned long repasses;
+    unsigned long latencias;    // repasses medidos (motores com espera no no)
+    double latencia_total;
+} recurso_t;
+
+// Pedidos de conjunto: todas as unidades de uma operacao sao concedidas
+// juntas ou nenhuma. Unidades livres e fila de pedidos ficam sob o mutex da
+// fila, que e sempre uma lista (a concessao a percorre em ordem).
+typedef struct {
+    fila_prioridade_t fila;
+    int livres[3];
+    unsigned long concessoes_imediatas;
+    unsigned long repasses;
+    unsigned long ultrapassagens;   // repasses a frente de um pedido bloqueado
+    unsigned long latencias;
+    double latencia_total;
+} alocador_conjuntos_t;
+
+// Prevencao pelo algoritmo do banqueiro: cada operacao declara o que vai usar
+// e uma unidade so e concedida se todos os avioes com operacao aberta ainda
+// podem terminar. Avioes que precisam do mesmo conjunto de recursos terminam
+// juntos, entao o estado e agregado por mascara do que falta (8 classes) e
+// os vetores cobrem os tres recursos de uma vez.
+typedef int vetor_recursos_t __attribute__((vector_size(4 * sizeof(int))));
+
+typedef struct {
+    vetor_recursos_t disponiveis;
+    int avioes_por_falta[8];
+    vetor_recursos_t posse_por_falta[8];
+    unsigned long concessoes;
+    unsigned long recusas;              // concessoes que deixariam o estado inseguro
+    pthread_mutex_t mutex;
+} banqueiro_t;
+
+typedef enum {
+    AQUISICAO_PASSOS,
+    AQUISICAO_CONJUNTO,
+    AQUISICAO_ORDENADA,
+    AQUISICAO_BANQUEIRO
+} tipo_aquisicao;
+
+typedef enum {
+    MOTOR_THREADS,
+    MOTOR_EVENTOS,
+    MOTOR_FIBRAS,
+    MOTOR_MAQUINA
+} tipo_motor;
+
+typedef struct {
+    tipo_motor motor;
+    unsigned int semente;
+    double escala_tempo;
+    int trabalhadores;
+    size_t pilha_fibra;
+    int max_avioes;
+    double fator_chegadas;
+    tipo_fila fila;
+    tipo_envelhecimento envelhecimento;
+    double taxa_envelhecimento; // linear: pontos de prioridade por segundo de espera
+    int carencia;               // degraus: segundos de espera antes do primeiro degrau
+    int bonus_espera;
+    int limiar_bonus;           // segundos; -1 = ALERTA_CRITICO / 2
+    tipo_aquisicao aquisicao;
+    tipo_recurso ordem_global[3];   // AQUISICAO_ORDENADA, do primeiro ao ultimo
+    size_t log_capacidade;          // registros no anel do log
+    politica_log_cheio log_cheio;
+    bool log_binario;               // simulacao.bin, para decodificar_log
+    int log_saidas;                 // SAIDA_LOG_*; -1 = padrao (so o arquivo com log_binario)
+    bool rastro;                    // simulacao.rastro, para ler_rastro
+} configuracao_t;
+
+// Grafo de alocacao: arestas de posse (slot segura uma unidade do recurso)
+// e de espera (slot aguarda o recurso), com o espaco de trabalho da busca.
 typedef struct {
     int recursos_disponiveis[3];
-    int matriz_alocacao[MAX_AVIOES][3];
-    int matriz_requisicao[MAX_AVIOES][3];
+    uint64_t* posse[3];             // bitsets por recurso, um bit por slot:
+    uint64_t* espera[3];            //   segura uma unidade / aguarda o recurso
+    int palavras;                   // palavras de 64 bits em cada bitset
+    int* detentores[3];             // slots que seguram cada recurso
+    int num_detentores[3];
+    unsigned int* visita;           // marca da ultima busca que alcancou o slot
+    unsigned int busca_atual;
+    int* alcancados;                // slots alcancados pela busca corrente
+    int* impasse;                   // slots em impasse encontrados pela busca
+    int capacidade;
+    unsigned long buscas;
+    unsigned long slots_visitados;
+} grafo_alocacao_t;
+
+// Copia do grafo que a verificacao periodica analisa sem travar nada. So a
+// thread que verifica mexe nela.
+typedef struct {
+    grafo_alocacao_t grafo;
+    unsigned long versao;           // versao do grafo vivo quando foi copiado
+    aviao_t** avioes;               // detector.avioes na mesma copia
+    int* verificados;               // pendentes no momento da copia; depois, os confirmados
+    int num_verificados;
+    int* soltos;                    // pendentes copiados que sairam do impasse
+    int num_soltos;
+    unsigned int* confirmado;       // verificacao em que o slot seguia em impasse
+    int* a_avisar;                  // slots em impasse que seguram algo
+    int num_a_avisar;
+    aviao_t** avisar;               // os avioes desses slots, avisados de uma vez
+    int* ids_avisar;                // ID de cada um, contra reuso do registro
+    int num_avisar;
+    double* custos;                 // custo de cada um como vitima
+    int* aguardados;                // recurso que cada um aguarda
+    int* grupos;                    // inicio de cada impasse em a_avisar e, conferidos, em avisar
+    bool* desfeitos;                // impasse com algum slot alterado depois da copia
+    int num_grupos;
+    aviao_t** vitimas;              // o de menor custo de cada impasse entre os que ja tem os avisos
+    int* ids_vitimas;               // ID de cada vitima, contra reuso do registro
+    aviao_t** herdeiros;            // tres por vitima: quem do impasse aguarda cada recurso
+    int* ids_herdeiros;
+    unsigned long copias;
+    double maior_trava;             // segundos, maior trecho com detector.mutex
+} retrato_alocacao_t;
+
+typedef struct {
+    grafo_alocacao_t grafo;         // atualizado a cada registro
+    unsigned long versao;           // conta as mudancas de aresta do grafo
+    unsigned long* versao_slot;     // versao da ultima mudanca de cada slot
+    retrato_alocacao_t retrato;
+    aviao_t** avioes;               // ultimo aviao registrado em cada slot
+    int (*posicao_detentor)[3];     // indice em detentores[r], -1 = nao segura
+    int* pendentes;                 // slots ja vistos em impasse, revalidados
+    unsigned long* pendente_desde;  //   a cada verificacao; versao em que o
+    int num_pendentes;              //   slot entrou, 0 = nao pendente
+    unsigned int verificacao_atual;
+    unsigned long verificacoes;
+    int capacidade;
     pthread_mutex_t mutex;
 } detector_deadlock_t;
 
 // ------------- VARIÁVEIS GLOBAIS -------------
+extern configuracao_t config;
+extern classe_voo_t classes_voo[NUM_CLASSES_VOO];
 extern detector_deadlock_t detector;
 extern int contador_deadlocks;
 extern int contador_starvation;
 extern int recursos_realocados;
 extern pthread_mutex_t mutex_contadores;
-extern aviao_t* avioes_com_warnings[MAX_AVIOES];
+extern aviao_t** avioes_com_warnings;
 extern int num_avioes_warnings;
+extern int capacidade_avioes_warnings;
 extern pthread_mutex_t mutex_warnings;
 extern bool sistema_ativo;
 extern pthread_mutex_t mutex_lista_avioes;
+extern _Atomic unsigned long alocacoes_heap;
+extern _Atomic unsigned long requisicoes_feitas;
 
-// -------------- SEMÁFOROS  --------------
-extern sem_t sem_pistas;
-extern sem_t sem_portoes;
-extern sem_t sem_torre_ops;
+// -------------- RECURSOS  --------------
+extern recurso_t recurso_pistas;
+extern recurso_t recurso_portoes;
+extern recurso_t recurso_torre_ops;
+extern alocador_conjuntos_t conjuntos;
+extern banqueiro_t banqueiro;
 
 // -------------- FILAS DE PRIORIDADE --------------
 extern fila_prioridade_t fila_pistas;
 extern fila_prioridade_t fila_portoes;
 extern fila_prioridade_t fila_torre_ops;
 
+// -------------- OPERAÇÕES --------------
+extern tipo_recurso ORDEM_RECURSOS[3][2][3];
+extern const int NUM_PASSOS_OPERACAO[3];
+extern const int CONJUNTO_OPERACAO[3];
+extern const int DURACAO_OPERACAO[3];
+extern const char* NOME_OPERACAO[3];
+extern const char* RECURSOS_OPERACAO[3];
+extern const char* MENSAGEM_ANDAMENTO[3];
+
 
 // ------------- PROTÓTIPOS DAS FUNÇÕES -------------
+int ler_opcoes(int argc, char* argv[], int inicio);
+void definir_ordem_global(const tipo_recurso ordem[3]);
+int executar_motor_eventos();
+void maquina_iniciar(int trabalhadores);
+void maquina_lancar_aviao(aviao_t* aviao);
+void maquina_aguardar();
+void registro_iniciar(size_t tamanho_registro);
+aviao_t* registro_obter();
+void registro_liberar(aviao_t* aviao);
+aviao_t* registro_aviao(int slot);
+int registro_capacidade();
+void registro_aguardar_vazio();
+void registro_destruir();
+void aviao_preparar_registro(aviao_t* aviao);
+void aviao_descartar_registro(aviao_t* aviao);
+int ler_classe_voo(const char* especificacao);
+tipo_de_voo sortear_classe_voo();
+double taxa_da_classe(tipo_de_voo tipo);
+int prioridade_base_do_aviao(const aviao_t* aviao);
+void inicializar_aviao(aviao_t* aviao, int id);
+void aviao_finalizado(aviao_t* aviao);
+double intervalo_chegada();
 void* rotina_aviao(void* arg);
+fila_prioridade_t* fila_do_recurso(tipo_recurso recurso);
+fila_prioridade_t* fila_do_no(const request_node_t* no);
+recurso_t* recurso_do_tipo(tipo_recurso recurso);
+const char* nome_do_recurso(tipo_recurso recurso);
 int solicitar_pista(aviao_t *aviao);
 void liberar_pista(aviao_t *aviao);
 int solicitar_portao(aviao_t *aviao);
@@ -125,24 +377,113 @@ int solicitar_desembarque(aviao_t *voo);
 void liberar_desembarque(aviao_t *voo);
 int solicitar_decolagem(aviao_t *voo);
 void liberar_decolagem(aviao_t *voo);
-int solicitar_recurso_com_prioridade(fila_prioridade_t* fila, sem_t* sem_recurso, aviao_t* aviao, tipo_recurso tipo, const char* nome_recurso);
-void liberar_recurso_com_prioridade(fila_prioridade_t* fila, sem_t* sem_recurso, aviao_t* aviao, const char* nome_recurso);
+void inicializar_recurso(recurso_t* recurso, tipo_recurso tipo, fila_prioridade_t* fila, int unidades);
+void definir_tratador_concessao(bool (*tratador)(request_node_t* no));
+void definir_tratador_preempcao(bool (*tratador)(request_node_t* no));
+bool recurso_interromper(aviao_t* aviao, int id, aviao_t* const herdeiros[3], const int ids_herdeiros[3]);
+void aviao_preemptado(aviao_t* aviao, tipo_operacao operacao);
+void aviao_esquecer_herdeiros(aviao_t* aviao);
+int recurso_solicitar(recurso_t* recurso, aviao_t* aviao);
+void recurso_devolver(recurso_t* recurso);
+bool entregar_ao_no(request_node_t* no);
+void recurso_registrar_estatisticas(recurso_t* recurso);
+int solicitar_recurso_com_prioridade(recurso_t* recurso, aviao_t* aviao);
+int solicitar_conjunto_com_prioridade(aviao_t* aviao, tipo_operacao operacao);
+void inicializar_conjuntos(int pistas, int portoes, int torre_ops);
+void destruir_conjuntos();
+int conjunto_solicitar(aviao_t* aviao, int recursos);
+void conjunto_devolver(int recursos);
+bool conjunto_desistir(aviao_t* aviao);
+bool conjunto_desistir_travado(request_node_t* no);
+void conjunto_aplicar_bonus(aviao_t* aviao);
+void conjuntos_registrar_estatisticas();
+void inicializar_banqueiro(int pistas, int portoes, int torre_ops);
+void destruir_banqueiro();
+void banqueiro_declarar(aviao_t* aviao, int recursos);
+bool banqueiro_conceder(aviao_t* aviao, tipo_recurso recurso);
+void banqueiro_desfazer(aviao_t* aviao, tipo_recurso recurso);
+void banqueiro_liberar(aviao_t* aviao, tipo_recurso recurso);
+void banqueiro_encerrar(aviao_t* aviao);
+void banqueiro_reavaliar();
+void banqueiro_registrar_estatisticas();
+void prazos_iniciar();
+void prazos_agendar(request_node_t* no, double segundos);
+void prazos_encerrar();
+void liberar_recurso_com_prioridade(recurso_t* recurso, aviao_t* aviao);
 void inicializar_fila(fila_prioridade_t* fila);
 void destruir_fila(fila_prioridade_t* fila);
+void fila_atualizar(fila_prioridade_t* fila);
+void fila_encerrar_envelhecimento();
+request_node_t* fila_cabeca(fila_prioridade_t* fila);
+request_node_t* fila_retirar_cabeca(fila_prioridade_t* fila);
+void fila_reprioritizar(fila_prioridade_t* fila, request_node_t* no, double chave);
+double prioridade_efetiva(const request_node_t* no, double agora);
+void fila_aplicar_bonus(fila_prioridade_t* fila, aviao_t* aviao, tipo_recurso recurso);
+bool fila_aplicar_bonus_no(fila_prioridade_t* fila, request_node_t* no);
 int adicionar_requisicao(fila_prioridade_t* fila, aviao_t* aviao, tipo_recurso recurso);
+int adicionar_requisicao_travada(fila_prioridade_t* fila, aviao_t* aviao, tipo_recurso recurso);
+int adicionar_no_travado(fila_prioridade_t* fila, request_node_t* novo);
 void remover_requisicao(fila_prioridade_t* fila, aviao_t* aviao);
-void* thread_aging_func(void* arg);
-void atualizar_prioridades(fila_prioridade_t* fila);
+bool remover_requisicao_travada(fila_prioridade_t* fila, aviao_t* aviao);
+bool remover_no_travado(fila_prioridade_t* fila, request_node_t* alvo);
+void relatorio_registrar_aviao(aviao_t* aviao);
+void exibir_relatorio_final();
+
+// Evento do aviao no rastro (--rastro), com a prioridade base que ele tem
+// nas filas; sem rastro, so um teste.
+#define rastrear(tipo, aviao, recurso, valor) \
+    rastro_evento(tipo, (aviao)->ID, recurso, prioridade_base_do_aviao(aviao), valor)
+
+// ------------- CONTABILIDADE DO DETECTOR -------------
+// So a aquisicao por passos pode formar espera circular. Nos outros modos o
+// detector nao roda e cada chamada de contabilidade se reduz a um teste.
+// Compilado com -DORDEM_GLOBAL o detector sai do binario, as chamadas somem
+// e a aquisicao padrao passa a ser a ordenada.
+#ifdef ORDEM_GLOBAL
+#define DETECTOR_ATIVO false
+#define AQUISICAO_PADRAO AQUISICAO_ORDENADA
+#define registrar_alocacao(aviao, recurso)      ((void)0)
+#define registrar_liberacao(aviao, recurso)     ((void)0)
+#define registrar_requisicao(aviao, recurso)    ((void)0)
+#define limpar_requisicao(aviao, recurso)       ((void)0)
+#define adicionar_aviao_warning(aviao)          ((void)0)
+#define remover_aviao_warning(aviao)            ((void)0)
+#define detector_garantir_capacidade(slots)     ((void)0)
+#define detector_esquecer_aviao(aviao)          ((void)0)
+#define inicializar_detector_deadlock()         ((void)0)
+#define destruir_detector_deadlock()            ((void)0)
+#define detector_registrar_estatisticas()       ((void)0)
+#define verificar_deadlock()                    ((void)0)
+#else
+#define DETECTOR_ATIVO (config.aquisicao == AQUISICAO_PASSOS)
+#define AQUISICAO_PADRAO AQUISICAO_PASSOS
+#define registrar_alocacao(aviao, recurso) \
+    (DETECTOR_ATIVO ? detector_registrar_alocacao(aviao, recurso) : (void)0)
+#define registrar_liberacao(aviao, recurso) \
+    (DETECTOR_ATIVO ? detector_registrar_liberacao(aviao, recurso) : (void)0)
+#define registrar_requisicao(aviao, recurso) \
+    (DETECTOR_ATIVO ? detector_registrar_requisicao(aviao, recurso) : (void)0)
+#define limpar_requisicao(aviao, recurso) \
+    (DETECTOR_ATIVO ? detector_limpar_requisicao(aviao, recurso) : (void)0)
+#define adicionar_aviao_warning(aviao) \
+    (DETECTOR_ATIVO ? detector_adicionar_warning(aviao) : (void)0)
+
 void inicializar_detector_deadlock();
+void detector_garantir_capacidade(int slots);
+void detector_esquecer_aviao(aviao_t* aviao);
+void destruir_detector_deadlock();
+void detector_registrar_estatisticas();
+int detector_contar_retencao_espera();
 void* thread_detectar_deadlock(void* arg);
-bool detectar_ciclo_deadlock();
-void registrar_alocacao(aviao_t* aviao, tipo_recurso recurso);
-void registrar_liberacao(aviao_t* aviao, tipo_recurso recurso);
-void registrar_requisicao(aviao_t* aviao, tipo_recurso recurso);
-void limpar_requisicao(aviao_t* aviao, tipo_recurso recurso);
-void adicionar_aviao_warning(aviao_t* aviao);
+void verificar_deadlock();
+void detector_registrar_alocacao(aviao_t* aviao, tipo_recurso recurso);
+void detector_registrar_liberacao(aviao_t* aviao, tipo_recurso recurso);
+void detector_registrar_requisicao(aviao_t* aviao, tipo_recurso recurso);
+void detector_limpar_requisicao(aviao_t* aviao, tipo_recurso recurso);
+void detector_adicionar_warning(aviao_t* aviao);
+void remover_aviao_warning(aviao_t* aviao);
 void realocar_recursos_avioes_warning();
 bool aviao_tem_muitos_warnings(aviao_t* aviao);
-void exibir_relatorio_final(aviao_t* avioes[], int total_avioes);
+#endif
 
 #endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef FIBRA_H
+#define FIBRA_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+// Fibras: corrotinas em espaco de usuario multiplexadas (M:N) sobre poucas
+// threads trabalhadoras. Bloquear uma fibra estaciona so a fibra; a thread
+// trabalhadora segue executando as outras.
+
+typedef struct fibra fibra_t;
+
+// Ponto de espera de um unico interessado. Para threads comuns e uma
+// pthread_cond_t; para fibras, guarda a fibra estacionada ate o sinal.
+typedef struct {
+    pthread_cond_t cond;
+    fibra_t* fibra;
+} espera_t;
+
+void fibras_iniciar(int trabalhadores, size_t tamanho_pilha);
+int fibra_criar(void* (*funcao)(void*), void* arg);
+void fibras_aguardar();
+fibra_t* fibra_atual();
+void fibra_dormir(const struct timespec* prazo);
+
+void espera_iniciar(espera_t* espera);
+void espera_destruir(espera_t* espera);
+int espera_aguardar(espera_t* espera, pthread_mutex_t* mutex, const struct timespec* prazo);
+void espera_sinalizar(espera_t* espera);
+
+#endif
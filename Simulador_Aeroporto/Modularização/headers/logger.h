@@ -2,9 +2,118 @@
 #define LOGGER_H
 
 #include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
 
-void log_init(const char* filename);
-void log_message(const char* format, ...);
+// log_message nao formata nada: registra o formato uma vez (a chave e o
+// ponteiro da string) e copia so o numero do formato, a data e os argumentos
+// crus para um anel limitado de registros. Uma thread escritora entrega cada
+// registro as saidas escolhidas em log_init, formatando o texto uma vez se
+// alguma delas precisa dele; o arquivo binario nao precisa, e decodificar_log
+// reconstroi o texto depois. Antes de log_init (benchmarks) a escrita e
+// direta no stdout.
+
+#define TAMANHO_REGISTRO_LOG    256     // bytes de argumentos por mensagem
+#define CAPACIDADE_LOG_PADRAO   4096
+#define MAX_ARGUMENTOS_LOG      16
+#define MAX_FORMATOS_LOG        1024
+#define TAMANHO_MEMORIA_LOG     (64 * 1024)     // texto guardado pela saida em memoria
+
+// Categorias e niveis. Cada chamada de log_evento diz os seus; o que fica
+// acima de LOG_NIVEL_MAXIMO ou em LOG_CATEGORIAS_OMITIDAS nem e compilado
+// (make LOG_NIVEL=INFO LOG_SEM="RECURSO"). O resto passa por um unico teste
+// contra o nivel da categoria em tempo de execucao (--log-nivel) e, so nas
+// categorias com limite (--log-limite, --log-amostra), pelo controle de taxa.
+typedef enum {
+    LOG_SISTEMA,
+    LOG_AVIAO,
+    LOG_RECURSO,
+    LOG_ALERTA,
+    LOG_DEADLOCK,
+    NUM_CATEGORIAS_LOG
+} categoria_log;
+
+typedef enum {
+    NIVEL_ERRO,
+    NIVEL_AVISO,
+    NIVEL_INFO,
+    NIVEL_DETALHE
+} nivel_log;
+
+#ifndef LOG_NIVEL_MAXIMO
+#define LOG_NIVEL_MAXIMO NIVEL_DETALHE
+#endif
+#ifndef LOG_CATEGORIAS_OMITIDAS
+#define LOG_CATEGORIAS_OMITIDAS 0
+#endif
+
+extern nivel_log log_niveis[NUM_CATEGORIAS_LOG];
+
+#define log_compilado(categoria, nivel) \
+    ((nivel) <= LOG_NIVEL_MAXIMO && !(LOG_CATEGORIAS_OMITIDAS & (1 << (categoria))))
+#define log_habilitado(categoria, nivel) \
+    (log_compilado(categoria, nivel) && (nivel) <= log_niveis[categoria])
+
+#define log_evento(categoria, nivel, ...)                       \
+    do {                                                        \
+        if (log_habilitado(categoria, nivel)) {                 \
+            log_categoria(categoria, nivel, __VA_ARGS__);       \
+        }                                                       \
+    } while (0)
+
+// O que log_message faz quando o anel esta cheio.
+typedef enum {
+    LOG_CHEIO_BLOQUEAR,     // espera a escritora abrir espaco (nada se perde)
+    LOG_CHEIO_DESCARTAR,    // descarta a mensagem nova e conta
+    LOG_CHEIO_SOBRESCREVER  // descarta a mensagem mais antiga e conta
+} politica_log_cheio;
+
+// Saidas do log (--log-saida), combinaveis. Cada uma junta o que recebe no
+// proprio buffer e conta bytes e mensagens; sem nenhuma ("nulo") a escritora
+// so esvazia o anel.
+typedef enum {
+    SAIDA_LOG_ARQUIVO = 1 << 0,     // simulacao.log, ou simulacao.bin com --log-binario
+    SAIDA_LOG_CONSOLE = 1 << 1,     // stdout
+    SAIDA_LOG_MEMORIA = 1 << 2,     // ultimos TAMANHO_MEMORIA_LOG bytes, lidos com log_memoria
+    SAIDA_LOG_JSON    = 1 << 3      // simulacao.jsonl, um objeto por mensagem
+} saida_log;
+
+#define SAIDAS_LOG_PADRAO (SAIDA_LOG_ARQUIVO | SAIDA_LOG_CONSOLE)
+
+// Como cada argumento e copiado: inteiros de ate 32 bits em 4 bytes, os de
+// 64 bits, doubles e ponteiros em 8, textos com o '\0'.
+typedef enum {
+    ARG_LOG_INT,
+    ARG_LOG_LONG,
+    ARG_LOG_DOUBLE,
+    ARG_LOG_TEXTO,
+    ARG_LOG_PONTEIRO
+} tipo_argumento_log;
+
+// Arquivo binario: MAGICO_LOG_BINARIO e depois registros marcados por um
+// byte, com inteiros na ordem da maquina:
+//   'F' id:u16 tamanho:u16 formato       formato novo, antes do primeiro uso
+//   'M' id:u16 tamanho:u16 data:i64 args mensagem
+//   'T' tamanho:u16 texto                texto pronto, sem data
+#define MAGICO_LOG_BINARIO      "AEROLOG1"
+#define LOG_BIN_FORMATO         'F'
+#define LOG_BIN_MENSAGEM        'M'
+#define LOG_BIN_TEXTO           'T'
+
+void log_init(const char* arquivo, const char* arquivo_json, size_t capacidade, politica_log_cheio politica,
+              bool binario, int saidas);
+void log_message(const char* format, ...) __attribute__((format(printf, 1, 2)));
+void log_categoria(categoria_log categoria, nivel_log nivel, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+int log_definir_nivel(const char* especificacao);
+int log_definir_limite(const char* especificacao, bool amostra);
+int log_ler_saidas(const char* especificacao);
+void log_esvaziar();
+size_t log_memoria(char* destino, size_t capacidade);
 void log_close();
 
-#endif
\ No newline at end of file
+int log_analisar_formato(const char* formato, tipo_argumento_log* tipos);
+size_t log_formatar(const char* formato, const unsigned char* argumentos, size_t tamanho, char* saida,
+                    size_t capacidade);
+
+#endif
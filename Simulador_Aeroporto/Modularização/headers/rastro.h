@@ -0,0 +1,71 @@
+#ifndef RASTRO_H
+#define RASTRO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Rastro binario das transicoes de recursos (--rastro), separado do log em
+// texto: um evento por pedido, concessao, liberacao, alerta, falha por
+// starvation, impasse e realocacao, com o tempo simulado em nanossegundos.
+// Os eventos nao tem tamanho fixo: um byte de tag e quatro campos em varint,
+// de 5 a MAX_EVENTO_RASTRO bytes. O arquivo so cresce, em segmentos de
+// TAMANHO_SEGMENTO_RASTRO bytes mapeados na memoria; cada segmento comeca
+// com um cabecalho e se decodifica sozinho. Cada evento ocupa:
+//   tipo | recurso << 4                 1 byte
+//   tempo - tempo do anterior           varint zigzag (no primeiro, desde tempo_base_ns)
+//   aviao                               varint
+//   prioridade, valor                   varint zigzag
+// O ultimo segmento e cortado no fim dos dados; bin/ler_rastro gera um CSV.
+
+#define MAGICO_RASTRO               "AERORST1"
+#define TAMANHO_SEGMENTO_RASTRO     (64 * 1024)
+#define MAX_EVENTO_RASTRO           26          // bytes de um evento codificado
+#define RECURSO_RASTRO_NENHUM       3
+
+typedef enum {
+    RASTRO_PEDIDO,
+    RASTRO_CONCESSAO,
+    RASTRO_LIBERACAO,
+    RASTRO_ALERTA,          // valor: segundos de espera
+    RASTRO_FALHA,           // valor: segundos de espera
+    RASTRO_IMPASSE,         // espera circular nova; valor: avioes no impasse
+    RASTRO_VERIFICACAO,     // impasses que persistem; valor: avioes avisados
+    RASTRO_REALOCACAO,      // vitima interrompida; valor: vitimas da rodada
+    NUM_TIPOS_RASTRO
+} tipo_evento_rastro;
+
+typedef struct {
+    int64_t tempo_ns;       // tempo simulado
+    int32_t aviao;          // ID, 0 = nenhum
+    int32_t prioridade;     // base do aviao na fila
+    int32_t valor;
+    uint8_t tipo;
+    uint8_t recurso;        // tipo_recurso ou RECURSO_RASTRO_NENHUM
+} evento_rastro_t;
+
+typedef struct {
+    char magico[8];
+    uint32_t eventos;
+    uint32_t bytes;         // de eventos, depois do cabecalho
+    int64_t tempo_base_ns;
+} cabecalho_segmento_rastro_t;
+
+extern bool rastro_ativo;
+
+// Sem rastro cada ponto de registro custa um teste; os argumentos nem sao
+// avaliados.
+#define rastro_evento(tipo, aviao, recurso, prioridade, valor)                  \
+    do {                                                                        \
+        if (rastro_ativo) rastro_registrar(tipo, aviao, recurso, prioridade, valor); \
+    } while (0)
+
+void rastro_iniciar(const char* caminho);
+void rastro_registrar(tipo_evento_rastro tipo, int aviao, int recurso, int prioridade, int valor);
+void rastro_encerrar();
+
+extern const char* NOMES_EVENTOS_RASTRO[NUM_TIPOS_RASTRO];
+size_t rastro_decodificar(const unsigned char* dados, size_t tamanho, int64_t* tempo_anterior,
+                          evento_rastro_t* evento);
+
+#endif
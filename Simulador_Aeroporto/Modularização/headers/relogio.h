@@ -0,0 +1,22 @@
+#ifndef RELOGIO_H
+#define RELOGIO_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+
+// Todo tempo da simulacao passa por aqui: segundos simulados desde o inicio,
+// com resolucao de nanossegundos. No modo real o relogio e o CLOCK_MONOTONIC
+// multiplicado pela escala; no modo virtual quem avanca e o motor de eventos.
+
+void relogio_iniciar(bool virtual, double escala);
+double relogio_agora();
+double relogio_real();
+time_t relogio_data();
+time_t relogio_data_grossa();
+void relogio_avancar(double instante);
+void relogio_dormir(double segundos);
+void relogio_prazo(double segundos, struct timespec* ts);
+void relogio_iniciar_cond(pthread_cond_t* cond);
+
+#endif
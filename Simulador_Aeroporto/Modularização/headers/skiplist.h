@@ -0,0 +1,44 @@
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Skiplist concorrente sem travas, ordenada por chave decrescente e, no
+// empate, por ordem crescente (o par e unico). Inserir, remover um elemento e
+// retirar o primeiro usam so CAS; a remocao marca os ponteiros do elemento
+// (bit baixo) e quem percorre a lista termina de desliga-lo.
+//
+// Cada insercao usa uma torre nova. Torres removidas so voltam a ser usadas
+// depois que nenhuma thread pode mais estar olhando para elas (reclamacao por
+// epocas), entao o mesmo valor pode ser reinserido logo em seguida.
+// Remover um valor especifico e reinseri-lo cabe ao dono do valor; a
+// retirada do primeiro pode ser feita por qualquer thread. A insercao grava a
+// torre em *torre antes de publica-la: depois disso o valor pode ja ter sido
+// retirado e reinserido por outra thread.
+
+#define NIVEIS_SKIPLIST 16
+
+typedef struct torre {
+    double chave;
+    unsigned long ordem;
+    void* valor;
+    int altura;
+    unsigned long epoca;                    // epoca em que foi aposentada
+    struct torre* livre;                    // listas de livres e aposentadas
+    _Atomic uintptr_t proximo[NIVEIS_SKIPLIST];
+} torre_t;
+
+typedef struct {
+    torre_t cabeca;
+} skiplist_t;
+
+void skiplist_iniciar(skiplist_t* lista);
+void skiplist_inserir(skiplist_t* lista, double chave, unsigned long ordem, void* valor, torre_t** torre);
+bool skiplist_remover(skiplist_t* lista, torre_t* torre);
+void* skiplist_primeiro(skiplist_t* lista);
+void* skiplist_retirar_primeiro(skiplist_t* lista);
+void skiplist_liberar_memoria();
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef TEMPORIZADOR_H
+#define TEMPORIZADOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Agenda de prazos em CLOCK_MONOTONIC (segundos): roda de temporizadores
+// hierarquica, com NIVEIS_RODA niveis de POSICOES_RODA posicoes e resolucao
+// de 1 ms. Inserir e disparar custam O(1); cada temporizador desce de nivel
+// no maximo NIVEIS_RODA - 1 vezes. Nao e sincronizada: quem usa protege com
+// o proprio mutex. "marca" permite ao dono descartar disparos que ficaram
+// velhos, entao nao ha cancelamento.
+
+#define NIVEIS_RODA     4
+#define POSICOES_RODA   64
+#define BITS_POSICAO    6
+
+typedef struct {
+    double prazo;
+    void* alvo;
+    unsigned long marca;
+    int tipo;
+} temporizador_t;
+
+typedef struct no_temporizador {
+    temporizador_t t;
+    unsigned long long tique;
+    struct no_temporizador* proximo;
+} no_temporizador_t;
+
+typedef struct {
+    no_temporizador_t* posicoes[NIVEIS_RODA][POSICOES_RODA];
+    unsigned long long ocupadas[NIVEIS_RODA];   // bit i: posicoes[n][i] nao vazia
+    no_temporizador_t* vencidos;
+    no_temporizador_t* livres;
+    void** blocos;
+    size_t num_blocos;
+    unsigned long long atual;   // proximo tique a processar
+    size_t pendentes;
+    unsigned long inseridos;
+    unsigned long disparados;
+} agenda_t;
+
+bool agenda_inserir(agenda_t* agenda, double prazo, void* alvo, unsigned long marca, int tipo);
+bool agenda_retirar_vencido(agenda_t* agenda, double agora, temporizador_t* saida);
+bool agenda_proximo_prazo(const agenda_t* agenda, double* prazo);
+void agenda_destruir(agenda_t* agenda);
+
+#endif
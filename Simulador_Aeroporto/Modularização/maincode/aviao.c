@@ -1,58 +1,148 @@
 #include "aeroporto.h"
 
-void *rotina_aviao(void *arg) {
-    aviao_t *aviao = (aviao_t *)arg;
+// Chamadas pelo registro quando um registro novo e criado e quando os blocos
+// sao devolvidos: os nos de requisicao vivem tanto quanto o registro.
+void aviao_preparar_registro(aviao_t *aviao) {
+    for (int i = 0; i < 3; i++) {
+        aviao->requisicoes[i].aviao = aviao;
+        aviao->requisicoes[i].recurso_desejado = (tipo_recurso)i;
+        aviao->requisicoes[i].na_fila = false;
+        aviao->requisicoes[i].recursos = 0;
+        espera_iniciar(&aviao->requisicoes[i].espera);
+    }
+    aviao->pedido_conjunto.aviao = aviao;
+    aviao->pedido_conjunto.na_fila = false;
+    aviao->pedido_conjunto.recursos = 0;
+    espera_iniciar(&aviao->pedido_conjunto.espera);
+    aviao->posicao_warning = -1;
+}
+
+void aviao_descartar_registro(aviao_t *aviao) {
+    for (int i = 0; i < 3; i++) {
+        espera_destruir(&aviao->requisicoes[i].espera);
+    }
+    espera_destruir(&aviao->pedido_conjunto.espera);
+}
+
+// Sorteia a classe de um aviao novo na proporcao dos pesos das classes.
+tipo_de_voo sortear_classe_voo() {
+    int peso_total = 0;
+    for (int i = 0; i < NUM_CLASSES_VOO; i++) peso_total += classes_voo[i].peso;
+
+    int sorteio = rand() % peso_total;
+    for (int i = 0; i < NUM_CLASSES_VOO; i++) {
+        if (sorteio < classes_voo[i].peso) return (tipo_de_voo)i;
+        sorteio -= classes_voo[i].peso;
+    }
+    return DOMESTICO;
+}
+
+double taxa_da_classe(tipo_de_voo tipo) {
+    double taxa = classes_voo[tipo].taxa_envelhecimento;
+    return taxa < 0 ? config.taxa_envelhecimento : taxa;
+}
+
+// Domesticos que ja foram vitimas de um impasse passam na frente.
+int prioridade_base_do_aviao(const aviao_t* aviao) {
+    if (aviao->recursos_realocados && aviao->tipo == DOMESTICO) return PRIORIDADE_REALOCADO;
+    return classes_voo[aviao->tipo].prioridade_base;
+}
+
+// O registro reciclado pode estar em um impasse da ultima verificacao, que
+// confere o ID sob mutex_warnings antes de contar avisos: ID e avisos mudam
+// juntos ali. Quem confere sob o mutex de uma fila le o ID atomicamente.
+void inicializar_aviao(aviao_t *aviao, int id) {
+    pthread_mutex_lock(&mutex_warnings);
+    atomic_store_explicit(&aviao->ID, id, memory_order_release);
+    aviao->deadlock_warnings = 0;
+    pthread_mutex_unlock(&mutex_warnings);
+    aviao->tipo = sortear_classe_voo();
+    aviao->rota = classes_voo[aviao->tipo].rota;
+    aviao->em_alerta = false;
+    aviao->tempo_de_criacao = relogio_agora();
+    aviao->estado = VOANDO;
+    aviao->recursos_realocados = false;
+    aviao_esquecer_herdeiros(aviao);
+    aviao->reivindicacao = 0;
+    aviao->obtidos = 0;
+    memset(aviao->recursos_alocados, 0, sizeof(aviao->recursos_alocados));
+}
+
+// Intervalo ate a chegada do proximo aviao; o fator de chegadas comprime o
+// intervalo original de 0.5s a 1.3s para perfis de trafego mais densos.
+double intervalo_chegada() {
+    return ((rand() % 800000 + 500000) / 1e6) / config.fator_chegadas;
+}
+
+// Contabiliza o aviao no relatorio e devolve seu registro para reuso. Depois
+// desta chamada o ponteiro nao pertence mais ao aviao.
+void aviao_finalizado(aviao_t *aviao) {
+    relatorio_registrar_aviao(aviao);
+    registro_liberar(aviao);
+}
+
+static void ciclo_aviao(aviao_t *aviao) {
 
     // --------------------------------- POUSO ---------------------------------
-    log_message("[AVIAO %03d] Iniciando procedimento de pouso.\n", aviao->ID);
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Iniciando procedimento de pouso.\n", aviao->ID);
     pthread_mutex_lock(&mutex_lista_avioes);
     aviao->estado = POUSANDO;
     pthread_mutex_unlock(&mutex_lista_avioes);
 
     if (solicitar_pouso(aviao) == -1) {
-        log_message("[AVIAO %03d] Falha ao obter recursos para pouso. Abortando.\n", aviao->ID);
-        pthread_exit(NULL);
+        log_evento(LOG_AVIAO, NIVEL_AVISO, "[AVIAO %03d] Falha ao obter recursos para pouso. Abortando.\n", aviao->ID);
+        return;
     }
-    log_message("[AVIAO %03d] Pouso em andamento (duracao: 2s).\n", aviao->ID);
-    sleep(2);
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Pouso em andamento (duracao: 2s).\n", aviao->ID);
+    relogio_dormir(2);
     liberar_pouso(aviao);
-    log_message("[AVIAO %03d] Pouso concluido. Recursos liberados.\n", aviao->ID);
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Pouso concluido. Recursos liberados.\n", aviao->ID);
 
     // ------------------------------- DESEMBARQUE -------------------------------
-    log_message("[AVIAO %03d] Iniciando procedimento de desembarque.\n", aviao->ID);
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Iniciando procedimento de desembarque.\n", aviao->ID);
     pthread_mutex_lock(&mutex_lista_avioes);
     aviao->estado = DESEMBARCANDO;
     pthread_mutex_unlock(&mutex_lista_avioes);
     
     if (solicitar_desembarque(aviao) == -1) {
-        log_message("[AVIAO %03d] Falha ao obter recursos para desembarque. Abortando.\n", aviao->ID);
-        pthread_exit(NULL);
+        log_evento(LOG_AVIAO, NIVEL_AVISO, "[AVIAO %03d] Falha ao obter recursos para desembarque. Abortando.\n",
+               aviao->ID);
+        return;
     }
-    log_message("[AVIAO %03d] Desembarque de passageiros em andamento (duracao: 3s).\n", aviao->ID);
-    sleep(3);
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Desembarque de passageiros em andamento (duracao: 3s).\n",
+           aviao->ID);
+    relogio_dormir(3);
     liberar_desembarque(aviao);
-    log_message("[AVIAO %03d] Desembarque concluido. Recursos liberados.\n", aviao->ID);
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Desembarque concluido. Recursos liberados.\n", aviao->ID);
 
     // -------------------------------- DECOLAGEM --------------------------------
-    log_message("[AVIAO %03d] Iniciando procedimento de decolagem.\n", aviao->ID);
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Iniciando procedimento de decolagem.\n", aviao->ID);
     pthread_mutex_lock(&mutex_lista_avioes);
     aviao->estado = DECOLANDO;
     pthread_mutex_unlock(&mutex_lista_avioes);
     
     if (solicitar_decolagem(aviao) == -1) {
-        log_message("[AVIAO %03d] Falha ao obter recursos para decolagem. Abortando.\n", aviao->ID);
-        pthread_exit(NULL);
+        log_evento(LOG_AVIAO, NIVEL_AVISO, "[AVIAO %03d] Falha ao obter recursos para decolagem. Abortando.\n",
+               aviao->ID);
+        return;
     }
-    log_message("[AVIAO %03d] Decolagem em andamento (duracao: 2s).\n", aviao->ID);
-    sleep(2);
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Decolagem em andamento (duracao: 2s).\n", aviao->ID);
+    relogio_dormir(2);
     liberar_decolagem(aviao);
-    log_message("[AVIAO %03d] Decolagem concluida. Recursos liberados.\n", aviao->ID);
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Decolagem concluida. Recursos liberados.\n", aviao->ID);
 
     pthread_mutex_lock(&mutex_lista_avioes);
     aviao->estado = CONCLUIDO;
     pthread_mutex_unlock(&mutex_lista_avioes);
 
-    log_message("[AVIAO %03d] Todas as operacoes foram concluidas com sucesso.\n", aviao->ID);
-    
-    pthread_exit(NULL);
-}
\ No newline at end of file
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Todas as operacoes foram concluidas com sucesso.\n", aviao->ID);
+}
+
+void *rotina_aviao(void *arg) {
+    aviao_t *aviao = (aviao_t *)arg;
+
+    ciclo_aviao(aviao);
+    aviao_finalizado(aviao);
+
+    return NULL;
+}
@@ -0,0 +1,163 @@
+#include "aeroporto.h"
+
+// ------------------------- ALGORITMO DO BANQUEIRO -------------------------
+// Com --aquisicao=banqueiro os recursos sao pedidos um a um, como em passos,
+// mas cada operacao declara antes tudo que vai usar (CONJUNTO_OPERACAO). Uma
+// unidade so e concedida se, depois dela, existe uma ordem em que todo aviao
+// com operacao aberta consegue o que falta e termina: nunca ha impasse, entao
+// nao ha detector nem realocacao.
+//
+// O estado fica sob banqueiro.mutex, travado depois do mutex da fila (a
+// concessao acontece com a fila travada). As filas sao listas: quem nao pode
+// ser atendido com seguranca e pulado e o proximo da fila e considerado.
+
+static const vetor_recursos_t FALTA[8] = {
+    { 0, 0, 0, 0 }, { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 1, 1, 0, 0 },
+    { 0, 0, 1, 0 }, { 1, 0, 1, 0 }, { 0, 1, 1, 0 }, { 1, 1, 1, 0 }
+};
+
+// Troca a reivindicacao e a posse do aviao, mudando-o de classe.
+static void mover(aviao_t* aviao, int reivindicacao, int obtidos) {
+    if (aviao->reivindicacao != 0) {
+        int classe = aviao->reivindicacao & ~aviao->obtidos;
+        banqueiro.avioes_por_falta[classe]--;
+        banqueiro.posse_por_falta[classe] -= FALTA[aviao->obtidos];
+    }
+    aviao->reivindicacao = reivindicacao;
+    aviao->obtidos = obtidos;
+    if (reivindicacao != 0) {
+        int classe = reivindicacao & ~obtidos;
+        banqueiro.avioes_por_falta[classe]++;
+        banqueiro.posse_por_falta[classe] += FALTA[obtidos];
+    }
+}
+
+// Uma classe termina quando o trabalho cobre o que falta a ela e devolve a
+// posse de todos os seus avioes. No maximo 7 rodadas sobre 7 classes.
+static bool seguro() {
+    vetor_recursos_t trabalho = banqueiro.disponiveis + banqueiro.posse_por_falta[0];
+    int abertas = 0;
+    for (int classe = 1; classe < 8; classe++) {
+        if (banqueiro.avioes_por_falta[classe] > 0) abertas |= 1 << classe;
+    }
+
+    bool progresso = true;
+    while (abertas != 0 && progresso) {
+        progresso = false;
+        for (int classe = 1; classe < 8; classe++) {
+            if (!(abertas & (1 << classe))) continue;
+            vetor_recursos_t insuficiente = trabalho < FALTA[classe];
+            if (insuficiente[0] | insuficiente[1] | insuficiente[2]) continue;
+            trabalho += banqueiro.posse_por_falta[classe];
+            abertas &= ~(1 << classe);
+            progresso = true;
+        }
+    }
+    return abertas == 0;
+}
+
+void inicializar_banqueiro(int pistas, int portoes, int torre_ops) {
+    memset(&banqueiro, 0, sizeof(banqueiro));
+    pthread_mutex_init(&banqueiro.mutex, NULL);
+    banqueiro.disponiveis[RECURSO_PISTA] = pistas;
+    banqueiro.disponiveis[RECURSO_PORTAO] = portoes;
+    banqueiro.disponiveis[RECURSO_TORRE] = torre_ops;
+}
+
+void destruir_banqueiro() {
+    pthread_mutex_destroy(&banqueiro.mutex);
+}
+
+// Declarar nao deixa o estado inseguro: sem segurar nada, o aviao termina
+// depois de todos os outros.
+void banqueiro_declarar(aviao_t* aviao, int recursos) {
+    if (config.aquisicao != AQUISICAO_BANQUEIRO) return;
+    pthread_mutex_lock(&banqueiro.mutex);
+    mover(aviao, recursos | aviao->obtidos, aviao->obtidos);
+    pthread_mutex_unlock(&banqueiro.mutex);
+}
+
+// Concede uma unidade se o estado resultante e seguro. Chamada com o mutex da
+// fila do recurso travado e so quando o recurso tem unidade livre.
+bool banqueiro_conceder(aviao_t* aviao, tipo_recurso recurso) {
+    int bit = 1 << recurso;
+
+    pthread_mutex_lock(&banqueiro.mutex);
+    int reivindicacao = aviao->reivindicacao, obtidos = aviao->obtidos;
+    mover(aviao, reivindicacao | bit, obtidos | bit);
+    banqueiro.disponiveis[recurso]--;
+
+    bool concedido = seguro();
+    if (concedido) {
+        banqueiro.concessoes++;
+    } else {
+        mover(aviao, reivindicacao, obtidos);
+        banqueiro.disponiveis[recurso]++;
+        banqueiro.recusas++;
+    }
+    pthread_mutex_unlock(&banqueiro.mutex);
+    return concedido;
+}
+
+// A concessao nao chegou ao aviao (a espera ja tinha expirado).
+void banqueiro_desfazer(aviao_t* aviao, tipo_recurso recurso) {
+    if (config.aquisicao != AQUISICAO_BANQUEIRO) return;
+    pthread_mutex_lock(&banqueiro.mutex);
+    mover(aviao, aviao->reivindicacao, aviao->obtidos & ~(1 << recurso));
+    banqueiro.disponiveis[recurso]++;
+    pthread_mutex_unlock(&banqueiro.mutex);
+}
+
+// O aviao devolveu a unidade e nao vai pedi-la de novo nesta operacao. A
+// redistribuicao fica com recurso_devolver, que devolve a unidade a fila.
+void banqueiro_liberar(aviao_t* aviao, tipo_recurso recurso) {
+    if (config.aquisicao != AQUISICAO_BANQUEIRO) return;
+    int bit = 1 << recurso;
+    pthread_mutex_lock(&banqueiro.mutex);
+    mover(aviao, aviao->reivindicacao & ~bit, aviao->obtidos & ~bit);
+    banqueiro.disponiveis[recurso]++;
+    pthread_mutex_unlock(&banqueiro.mutex);
+}
+
+// A operacao falhou: o que faltava deixa de ser reivindicado, o que pode
+// tornar seguros pedidos que estavam esperando.
+void banqueiro_encerrar(aviao_t* aviao) {
+    if (config.aquisicao != AQUISICAO_BANQUEIRO) return;
+    pthread_mutex_lock(&banqueiro.mutex);
+    mover(aviao, aviao->obtidos, aviao->obtidos);
+    pthread_mutex_unlock(&banqueiro.mutex);
+    banqueiro_reavaliar();
+}
+
+// Percorre as filas em ordem de prioridade e concede o que for seguro
+// enquanto houver unidades livres. Chamada sem nenhuma fila travada.
+void banqueiro_reavaliar() {
+    for (int r = 0; r < 3; r++) {
+        recurso_t* recurso = recurso_do_tipo((tipo_recurso)r);
+        fila_prioridade_t* fila = recurso->fila;
+
+        pthread_mutex_lock(&fila->mutex);
+        fila_atualizar(fila);
+        request_node_t* no = fila->head;
+        while (no != NULL && recurso->livres > 0) {
+            request_node_t* proximo = no->next;
+            if (banqueiro_conceder(no->aviao, (tipo_recurso)r)) {
+                remover_no_travado(fila, no);
+                recurso->livres--;
+                if (entregar_ao_no(no)) {
+                    recurso->repasses++;
+                } else {
+                    banqueiro_desfazer(no->aviao, (tipo_recurso)r);
+                    recurso->livres++;
+                }
+            }
+            no = proximo;
+        }
+        pthread_mutex_unlock(&fila->mutex);
+    }
+}
+
+void banqueiro_registrar_estatisticas() {
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Banqueiro: %lu concessoes seguras, %lu recusadas por deixarem o estado inseguro.\n",
+           banqueiro.concessoes, banqueiro.recusas);
+}
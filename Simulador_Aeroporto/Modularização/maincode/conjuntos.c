@@ -0,0 +1,155 @@
+#include "aeroporto.h"
+
+// ------------------------- PEDIDOS DE CONJUNTO -------------------------
+// Com --aquisicao=conjunto cada operacao pede de uma vez tudo de que precisa
+// (CONJUNTO_OPERACAO) e recebe tudo junto: nenhum aviao segura um portao
+// enquanto espera uma pista, entao nao ha espera circular.
+//
+// A cada mudanca (pedido novo, unidade devolvida, desistencia, bonus) a fila
+// e percorrida em ordem de prioridade. Um pedido e atendido se cabe no que
+// sobrou depois das reservas dos pedidos a sua frente; quem nao cabe reserva
+// todas as unidades que pede. Pedidos menores podem passar a frente de um
+// bloqueado, mas nunca com unidades de que ele precisa: ele nao espera mais
+// do que esperaria se fosse atendido estritamente em ordem.
+
+static bool cabe(int recursos, const int* sobra) {
+    for (int r = 0; r < 3; r++) {
+        if ((recursos & (1 << r)) && sobra[r] < 1) return false;
+    }
+    return true;
+}
+
+static void descontar(int* unidades, int recursos, int quantidade) {
+    for (int r = 0; r < 3; r++) {
+        if (recursos & (1 << r)) unidades[r] -= quantidade;
+    }
+}
+
+// Uma passada pela fila. "solicitante" acabou de entrar e, se for atendido,
+// recebe a resposta de conjunto_solicitar em vez do tratador. Retorna false
+// se um tratador recusou: as unidades voltaram e a passada deve recomecar,
+// porque pedidos ja deixados para tras podem caber agora.
+static bool passada(request_node_t* solicitante, bool* solicitante_atendido) {
+    int sobra[3] = { conjuntos.livres[0], conjuntos.livres[1], conjuntos.livres[2] };
+    bool bloqueado_a_frente = false;
+    fila_atualizar(&conjuntos.fila);
+    request_node_t* no = conjuntos.fila.head;
+
+    while (no != NULL && (sobra[0] > 0 || sobra[1] > 0 || sobra[2] > 0)) {
+        request_node_t* proximo = no->next;
+
+        if (!cabe(no->recursos, sobra)) {
+            descontar(sobra, no->recursos, 1);
+            bloqueado_a_frente = true;
+            no = proximo;
+            continue;
+        }
+
+        remover_no_travado(&conjuntos.fila, no);
+        descontar(sobra, no->recursos, 1);
+        descontar(conjuntos.livres, no->recursos, 1);
+        if (no == solicitante) {
+            no->atendido = true;
+            *solicitante_atendido = true;
+            conjuntos.concessoes_imediatas++;
+        } else if (entregar_ao_no(no)) {
+            conjuntos.repasses++;
+            if (bloqueado_a_frente) conjuntos.ultrapassagens++;
+        } else {
+            descontar(conjuntos.livres, no->recursos, -1);
+            return false;
+        }
+        no = proximo;
+    }
+    return true;
+}
+
+// Chamada com o mutex da fila travado.
+static bool redistribuir(request_node_t* solicitante) {
+    bool solicitante_atendido = false;
+    while (!passada(solicitante, &solicitante_atendido)) {
+    }
+    return solicitante_atendido;
+}
+
+void inicializar_conjuntos(int pistas, int portoes, int torre_ops) {
+    inicializar_fila(&conjuntos.fila);
+    conjuntos.fila.tipo = FILA_LISTA;
+    conjuntos.livres[RECURSO_PISTA] = pistas;
+    conjuntos.livres[RECURSO_PORTAO] = portoes;
+    conjuntos.livres[RECURSO_TORRE] = torre_ops;
+    conjuntos.concessoes_imediatas = 0;
+    conjuntos.repasses = 0;
+    conjuntos.ultrapassagens = 0;
+    conjuntos.latencias = 0;
+    conjuntos.latencia_total = 0;
+}
+
+void destruir_conjuntos() {
+    destruir_fila(&conjuntos.fila);
+}
+
+// Retorna 1 se o conjunto foi concedido na hora, 0 se o pedido entrou na
+// fila ou -1 se nao foi possivel enfileira-lo.
+int conjunto_solicitar(aviao_t* aviao, int recursos) {
+    request_node_t* no = &aviao->pedido_conjunto;
+
+    pthread_mutex_lock(&conjuntos.fila.mutex);
+    if (conjuntos.fila.head == NULL && cabe(recursos, conjuntos.livres)) {
+        descontar(conjuntos.livres, recursos, 1);
+        conjuntos.concessoes_imediatas++;
+        pthread_mutex_unlock(&conjuntos.fila.mutex);
+        return 1;
+    }
+
+    no->recursos = recursos;
+    if (adicionar_no_travado(&conjuntos.fila, no) == -1) {
+        pthread_mutex_unlock(&conjuntos.fila.mutex);
+        return -1;
+    }
+    bool atendido = redistribuir(no);
+    pthread_mutex_unlock(&conjuntos.fila.mutex);
+    return atendido ? 1 : 0;
+}
+
+// Devolve uma unidade de cada recurso marcado em "recursos".
+void conjunto_devolver(int recursos) {
+    pthread_mutex_lock(&conjuntos.fila.mutex);
+    descontar(conjuntos.livres, recursos, -1);
+    redistribuir(NULL);
+    pthread_mutex_unlock(&conjuntos.fila.mutex);
+}
+
+// Tira o pedido da fila; false se ele ja tinha sido atendido. As reservas
+// dele deixam de valer, entao quem estava atras pode caber agora.
+bool conjunto_desistir_travado(request_node_t* no) {
+    if (!remover_no_travado(&conjuntos.fila, no)) return false;
+    redistribuir(NULL);
+    return true;
+}
+
+bool conjunto_desistir(aviao_t* aviao) {
+    pthread_mutex_lock(&conjuntos.fila.mutex);
+    bool removido = conjunto_desistir_travado(&aviao->pedido_conjunto);
+    pthread_mutex_unlock(&conjuntos.fila.mutex);
+    return removido;
+}
+
+void conjunto_aplicar_bonus(aviao_t* aviao) {
+    if (fila_aplicar_bonus_no(&conjuntos.fila, &aviao->pedido_conjunto)) {
+        pthread_mutex_lock(&conjuntos.fila.mutex);
+        redistribuir(NULL);
+        pthread_mutex_unlock(&conjuntos.fila.mutex);
+    }
+}
+
+void conjuntos_registrar_estatisticas() {
+    if (conjuntos.latencias == 0) {
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Conjuntos: %lu concessoes imediatas, %lu repasses (%lu a frente de pedidos bloqueados).\n",
+               conjuntos.concessoes_imediatas, conjuntos.repasses, conjuntos.ultrapassagens);
+        return;
+    }
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Conjuntos: %lu concessoes imediatas, %lu repasses (%lu a frente de pedidos bloqueados), latencia media do repasse %.1f us.\n",
+           conjuntos.concessoes_imediatas, conjuntos.repasses, conjuntos.ultrapassagens,
+           conjuntos.latencia_total / conjuntos.latencias * 1e6);
+}
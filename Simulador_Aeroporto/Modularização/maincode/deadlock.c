@@ -1,177 +1,678 @@
 #include "aeroporto.h"
 
+// Com -DORDEM_GLOBAL nao ha detector (veja aeroporto.h).
+#ifndef ORDEM_GLOBAL
+
+// ------------------------- GRAFO DE ALOCACAO -------------------------
+// Cada registro atualiza so as arestas do aviao. Uma espera nova e a unica
+// mudanca que pode criar um impasse, entao a busca parte dela e percorre so o
+// que ela alcanca: o recurso aguardado, quem o segura, o que esses aguardam.
+// Com recursos de varias unidades um ciclo nao basta; o subgrafo alcancado e
+// reduzido (quem nao espera, ou espera um recurso com unidade sobrando, pode
+// terminar e devolver o que segura) e so quem sobra esta em impasse.
+//
+// Posse e espera ficam em um bitset por recurso, um bit por slot: o que a
+// busca consulta por slot sao testes de bit, e o que percorre a tabela
+// inteira (quem segura e espera ao mesmo tempo) anda 256 slots por vez.
+//
+// A verificacao periodica nao analisa o grafo vivo: com detector.mutex ela
+// so copia o grafo para o retrato (se mudou desde a ultima copia), analisa a
+// copia sem travar nada e volta ao mutex para atualizar os pendentes.
+
+static bool tem_bit(const uint64_t* bits, int slot) {
+    return (bits[slot >> 6] >> (slot & 63)) & 1;
+}
+
+static void por_bit(uint64_t* bits, int slot) {
+    bits[slot >> 6] |= 1ULL << (slot & 63);
+}
+
+static void tirar_bit(uint64_t* bits, int slot) {
+    bits[slot >> 6] &= ~(1ULL << (slot & 63));
+}
+
+static int aguardado(const grafo_alocacao_t* grafo, int slot) {
+    for (int r = 0; r < 3; r++) {
+        if (tem_bit(grafo->espera[r], slot)) return r;
+    }
+    return -1;
+}
+
+static bool segura_algo(const grafo_alocacao_t* grafo, int slot) {
+    return tem_bit(grafo->posse[0], slot) || tem_bit(grafo->posse[1], slot) || tem_bit(grafo->posse[2], slot);
+}
+
+// Quantos slots seguram algum recurso e esperam outro: (posse0 | posse1 |
+// posse2) & (espera0 | espera1 | espera2), contado por popcount.
+typedef uint64_t bloco_bits_t __attribute__((vector_size(4 * sizeof(uint64_t))));
+
+static int contar_retencao_espera(const grafo_alocacao_t* grafo) {
+    int total = 0;
+    int palavra = 0;
+    for (; palavra + 4 <= grafo->palavras; palavra += 4) {
+        bloco_bits_t posse[3], espera[3];
+        for (int r = 0; r < 3; r++) {
+            memcpy(&posse[r], grafo->posse[r] + palavra, sizeof(bloco_bits_t));
+            memcpy(&espera[r], grafo->espera[r] + palavra, sizeof(bloco_bits_t));
+        }
+        bloco_bits_t ambos = (posse[0] | posse[1] | posse[2]) & (espera[0] | espera[1] | espera[2]);
+        total += __builtin_popcountll(ambos[0]) + __builtin_popcountll(ambos[1]) +
+                 __builtin_popcountll(ambos[2]) + __builtin_popcountll(ambos[3]);
+    }
+    for (; palavra < grafo->palavras; palavra++) {
+        uint64_t ambos = (grafo->posse[0][palavra] | grafo->posse[1][palavra] | grafo->posse[2][palavra]) &
+                         (grafo->espera[0][palavra] | grafo->espera[1][palavra] | grafo->espera[2][palavra]);
+        total += __builtin_popcountll(ambos);
+    }
+    return total;
+}
+
+int detector_contar_retencao_espera() {
+    pthread_mutex_lock(&detector.mutex);
+    int total = contar_retencao_espera(&detector.grafo);
+    pthread_mutex_unlock(&detector.mutex);
+    return total;
+}
+
 void inicializar_detector_deadlock() {
+    memset(&detector, 0, sizeof(detector));
     pthread_mutex_init(&detector.mutex, NULL);
-    detector.recursos_disponiveis[0] = NUM_PISTAS;
-    detector.recursos_disponiveis[1] = NUM_PORTOES;
-    detector.recursos_disponiveis[2] = NUM_OP_TORRES;
-    
-    memset(detector.matriz_alocacao, 0, sizeof(detector.matriz_alocacao));
-    memset(detector.matriz_requisicao, 0, sizeof(detector.matriz_requisicao));
+    detector.grafo.recursos_disponiveis[0] = NUM_PISTAS;
+    detector.grafo.recursos_disponiveis[1] = NUM_PORTOES;
+    detector.grafo.recursos_disponiveis[2] = NUM_OP_TORRES;
+    // Versao 0 e a de "nunca copiado" e a de "nao pendente".
+    detector.versao = 1;
+}
+
+static void* expandir(void* vetor, size_t tamanho, int antigos, int novos, int byte_inicial) {
+    char* novo = realloc(vetor, novos * tamanho);
+    if (novo == NULL) {
+        perror("Falha ao expandir o grafo do detector");
+        exit(EXIT_FAILURE);
+    }
+    memset(novo + antigos * tamanho, byte_inicial, (novos - antigos) * tamanho);
+    return novo;
+}
+
+static void expandir_grafo(grafo_alocacao_t* grafo, int slots) {
+    int antigos = grafo->capacidade;
+    int palavras = (slots + 63) / 64;
+    for (int r = 0; r < 3; r++) {
+        grafo->posse[r] = expandir(grafo->posse[r], sizeof(uint64_t), grafo->palavras, palavras, 0);
+        grafo->espera[r] = expandir(grafo->espera[r], sizeof(uint64_t), grafo->palavras, palavras, 0);
+        grafo->detentores[r] = expandir(grafo->detentores[r], sizeof(int), antigos, slots, 0);
+    }
+    grafo->palavras = palavras;
+    grafo->visita = expandir(grafo->visita, sizeof(unsigned int), antigos, slots, 0);
+    grafo->alcancados = expandir(grafo->alcancados, sizeof(int), antigos, slots, 0);
+    grafo->impasse = expandir(grafo->impasse, sizeof(int), antigos, slots, 0);
+    grafo->capacidade = slots;
+}
+
+static void liberar_grafo(grafo_alocacao_t* grafo) {
+    for (int r = 0; r < 3; r++) {
+        free(grafo->posse[r]);
+        free(grafo->espera[r]);
+        free(grafo->detentores[r]);
+    }
+    free(grafo->visita);
+    free(grafo->alcancados);
+    free(grafo->impasse);
+}
+
+// O grafo acompanha o registro de avioes: uma linha por slot. O retrato
+// cresce antes de ser copiado, pela thread que verifica.
+void detector_garantir_capacidade(int slots) {
+    pthread_mutex_lock(&detector.mutex);
+    int antigos = detector.capacidade;
+    if (slots > antigos) {
+        expandir_grafo(&detector.grafo, slots);
+        detector.posicao_detentor = expandir(detector.posicao_detentor, sizeof(*detector.posicao_detentor), antigos, slots, 0xff);
+        detector.avioes = expandir(detector.avioes, sizeof(aviao_t*), antigos, slots, 0);
+        detector.versao_slot = expandir(detector.versao_slot, sizeof(unsigned long), antigos, slots, 0);
+        detector.pendente_desde = expandir(detector.pendente_desde, sizeof(unsigned long), antigos, slots, 0);
+        detector.pendentes = expandir(detector.pendentes, sizeof(int), antigos, slots, 0);
+        detector.capacidade = slots;
+    }
+    pthread_mutex_unlock(&detector.mutex);
+}
+
+void detector_registrar_estatisticas() {
+    const grafo_alocacao_t* vivo = &detector.grafo;
+    const retrato_alocacao_t* retrato = &detector.retrato;
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Detector: %lu buscas a partir de esperas novas, %.1f slots visitados por busca.\n",
+           vivo->buscas, vivo->buscas ? (double)vivo->slots_visitados / vivo->buscas : 0.0);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Detector: %lu verificacoes com pendentes, %lu copias do grafo, %lu buscas sobre as copias, "
+           "no maximo %.1f us com o mutex.\n",
+           detector.verificacoes, retrato->copias, retrato->grafo.buscas, retrato->maior_trava * 1e6);
+}
+
+void destruir_detector_deadlock() {
+    liberar_grafo(&detector.grafo);
+    liberar_grafo(&detector.retrato.grafo);
+    free(detector.retrato.avioes);
+    free(detector.retrato.verificados);
+    free(detector.retrato.soltos);
+    free(detector.retrato.confirmado);
+    free(detector.retrato.a_avisar);
+    free(detector.retrato.avisar);
+    free(detector.retrato.ids_avisar);
+    free(detector.retrato.custos);
+    free(detector.retrato.aguardados);
+    free(detector.retrato.grupos);
+    free(detector.retrato.desfeitos);
+    free(detector.retrato.vitimas);
+    free(detector.retrato.ids_vitimas);
+    free(detector.retrato.herdeiros);
+    free(detector.retrato.ids_herdeiros);
+    free(detector.posicao_detentor);
+    free(detector.avioes);
+    free(detector.versao_slot);
+    free(detector.pendente_desde);
+    free(detector.pendentes);
+    pthread_mutex_destroy(&detector.mutex);
+    memset(&detector, 0, sizeof(detector));
+}
+
+// Arestas do grafo vivo. Chamadas com detector.mutex travado. Cada mudanca
+// de um slot avanca a versao do grafo e fica registrada no slot.
+static void mudar_slot(int slot) {
+    detector.versao_slot[slot] = ++detector.versao;
+}
+
+static void segurar(int slot, int recurso) {
+    grafo_alocacao_t* grafo = &detector.grafo;
+    if (tem_bit(grafo->posse[recurso], slot)) return;
+    por_bit(grafo->posse[recurso], slot);
+    grafo->recursos_disponiveis[recurso]--;
+    detector.posicao_detentor[slot][recurso] = grafo->num_detentores[recurso];
+    grafo->detentores[recurso][grafo->num_detentores[recurso]++] = slot;
+    mudar_slot(slot);
+}
+
+static void soltar(int slot, int recurso) {
+    grafo_alocacao_t* grafo = &detector.grafo;
+    if (!tem_bit(grafo->posse[recurso], slot)) return;
+    tirar_bit(grafo->posse[recurso], slot);
+    grafo->recursos_disponiveis[recurso]++;
+
+    int posicao = detector.posicao_detentor[slot][recurso];
+    int ultimo = grafo->detentores[recurso][--grafo->num_detentores[recurso]];
+    grafo->detentores[recurso][posicao] = ultimo;
+    detector.posicao_detentor[ultimo][recurso] = posicao;
+    detector.posicao_detentor[slot][recurso] = -1;
+    mudar_slot(slot);
+}
+
+static void devolver_posses(const grafo_alocacao_t* grafo, int slot, int* trabalho) {
+    for (int r = 0; r < 3; r++) {
+        trabalho[r] += tem_bit(grafo->posse[r], slot);
+    }
+}
+
+// Busca a partir de "inicio" e reducao do que ela alcancou. Grava em
+// grafo->impasse os slots que nao podem terminar e retorna quantos sao.
+static int analisar(grafo_alocacao_t* grafo, int inicio) {
+    unsigned int marca = ++grafo->busca_atual;
+    if (marca == 0) {
+        memset(grafo->visita, 0, grafo->capacidade * sizeof(unsigned int));
+        marca = ++grafo->busca_atual;
+    }
+
+    int num = 0;
+    bool expandido[3] = { false, false, false };
+    grafo->alcancados[num++] = inicio;
+    grafo->visita[inicio] = marca;
+    for (int i = 0; i < num; i++) {
+        int recurso = aguardado(grafo, grafo->alcancados[i]);
+        if (recurso < 0 || expandido[recurso]) continue;
+        expandido[recurso] = true;
+        for (int j = 0; j < grafo->num_detentores[recurso]; j++) {
+            int detentor = grafo->detentores[recurso][j];
+            if (grafo->visita[detentor] != marca) {
+                grafo->visita[detentor] = marca;
+                grafo->alcancados[num++] = detentor;
+            }
+        }
+    }
+    grafo->buscas++;
+    grafo->slots_visitados += num;
+
+    // Todos os detentores de um recurso aguardado foram alcancados: as
+    // unidades que podem voltar para ele estao todas em "trabalho".
+    int trabalho[3];
+    for (int r = 0; r < 3; r++) {
+        trabalho[r] = grafo->recursos_disponiveis[r] > 0 ? grafo->recursos_disponiveis[r] : 0;
+    }
+    for (int i = 0; i < num; i++) {
+        if (aguardado(grafo, grafo->alcancados[i]) < 0) devolver_posses(grafo, grafo->alcancados[i], trabalho);
+    }
+
+    // Cada aviao espera um recurso so: quando um recurso tem unidade, todos
+    // que o aguardam terminam. Tres recursos, no maximo tres rodadas.
+    bool atendido[3] = { false, false, false };
+    bool mudou = true;
+    while (mudou) {
+        mudou = false;
+        for (int r = 0; r < 3; r++) {
+            if (atendido[r] || trabalho[r] == 0) continue;
+            atendido[r] = true;
+            mudou = true;
+            for (int i = 0; i < num; i++) {
+                if (tem_bit(grafo->espera[r], grafo->alcancados[i])) devolver_posses(grafo, grafo->alcancados[i], trabalho);
+            }
+        }
+    }
+
+    int em_impasse = 0;
+    for (int i = 0; i < num; i++) {
+        int recurso = aguardado(grafo, grafo->alcancados[i]);
+        if (recurso >= 0 && !atendido[recurso]) grafo->impasse[em_impasse++] = grafo->alcancados[i];
+    }
+    return em_impasse;
+}
+
+static void marcar_pendentes(int em_impasse) {
+    for (int i = 0; i < em_impasse; i++) {
+        int slot = detector.grafo.impasse[i];
+        if (detector.pendente_desde[slot] == 0) {
+            detector.pendentes[detector.num_pendentes++] = slot;
+        }
+        detector.pendente_desde[slot] = detector.versao;
+    }
 }
 
-void registrar_alocacao(aviao_t* aviao, tipo_recurso recurso) {
+// O slot vai ser reaproveitado. Unidades que o aviao nao liberou tambem nao
+// voltaram ao recurso: somem as arestas, nao a contagem.
+void detector_esquecer_aviao(aviao_t* aviao) {
     pthread_mutex_lock(&detector.mutex);
-    detector.matriz_alocacao[aviao->ID - 1][recurso] = 1;
-    detector.recursos_disponiveis[recurso]--;
+    grafo_alocacao_t* grafo = &detector.grafo;
+    for (int r = 0; r < 3; r++) {
+        if (tem_bit(grafo->posse[r], aviao->slot)) {
+            soltar(aviao->slot, r);
+            grafo->recursos_disponiveis[r]--;
+        }
+        tirar_bit(grafo->espera[r], aviao->slot);
+    }
+    detector.avioes[aviao->slot] = NULL;
+    mudar_slot(aviao->slot);
+    pthread_mutex_unlock(&detector.mutex);
+}
+
+void detector_registrar_alocacao(aviao_t* aviao, tipo_recurso recurso) {
+    pthread_mutex_lock(&detector.mutex);
+    segurar(aviao->slot, recurso);
     aviao->recursos_alocados[recurso] = 1;
     pthread_mutex_unlock(&detector.mutex);
 }
 
-void registrar_liberacao(aviao_t* aviao, tipo_recurso recurso) {
+void detector_registrar_liberacao(aviao_t* aviao, tipo_recurso recurso) {
     pthread_mutex_lock(&detector.mutex);
-    detector.matriz_alocacao[aviao->ID - 1][recurso] = 0;
-    detector.recursos_disponiveis[recurso]++;
+    soltar(aviao->slot, recurso);
     aviao->recursos_alocados[recurso] = 0;
     pthread_mutex_unlock(&detector.mutex);
 }
 
-void registrar_requisicao(aviao_t* aviao, tipo_recurso recurso) {
+void detector_registrar_requisicao(aviao_t* aviao, tipo_recurso recurso) {
     pthread_mutex_lock(&detector.mutex);
-    detector.matriz_requisicao[aviao->ID - 1][recurso] = 1;
+    grafo_alocacao_t* grafo = &detector.grafo;
+    for (int r = 0; r < 3; r++) {
+        tirar_bit(grafo->espera[r], aviao->slot);
+    }
+    por_bit(grafo->espera[recurso], aviao->slot);
+    detector.avioes[aviao->slot] = aviao;
+    mudar_slot(aviao->slot);
+
+    // So conta se quem acabou de pedir ficou preso; um impasse que ja tinha
+    // avioes pendentes so cresceu.
+    int em_impasse = analisar(grafo, aviao->slot);
+    bool preso = false, existente = false;
+    for (int i = 0; i < em_impasse; i++) {
+        if (grafo->impasse[i] == aviao->slot) preso = true;
+        if (detector.pendente_desde[grafo->impasse[i]] != 0) existente = true;
+    }
+    if (preso && existente) {
+        log_evento(LOG_DEADLOCK, NIVEL_AVISO, "[DEADLOCK] Aviao [%03d] aguarda %s e entrou em um impasse de %d avioes.\n",
+               aviao->ID, nome_do_recurso(recurso), em_impasse);
+    } else if (preso) {
+        pthread_mutex_lock(&mutex_contadores);
+        contador_deadlocks++;
+        pthread_mutex_unlock(&mutex_contadores);
+        log_evento(LOG_DEADLOCK, NIVEL_AVISO, "[DEADLOCK] Espera circular: Aviao [%03d] aguarda %s, %d avioes em impasse.\n",
+               aviao->ID, nome_do_recurso(recurso), em_impasse);
+    }
+    if (preso) {
+        marcar_pendentes(em_impasse);
+        rastrear(RASTRO_IMPASSE, aviao, recurso, em_impasse);
+    }
     pthread_mutex_unlock(&detector.mutex);
 }
 
-void limpar_requisicao(aviao_t* aviao, tipo_recurso recurso) {
+void detector_limpar_requisicao(aviao_t* aviao, tipo_recurso recurso) {
     pthread_mutex_lock(&detector.mutex);
-    detector.matriz_requisicao[aviao->ID - 1][recurso] = 0;
+    if (tem_bit(detector.grafo.espera[recurso], aviao->slot)) {
+        tirar_bit(detector.grafo.espera[recurso], aviao->slot);
+        mudar_slot(aviao->slot);
+    }
     pthread_mutex_unlock(&detector.mutex);
 }
 
-bool detectar_ciclo_deadlock() {
-    pthread_mutex_lock(&detector.mutex);
-    
-    bool deadlock_detectado = false;
-    int avioes_esperando = 0;
-    int recursos_bloqueados = 0;
-    
-    for (int i = 0; i < MAX_AVIOES; i++) {
-        bool esperando = false;
-        bool tem_recursos = false;
-        
-        for (int j = 0; j < 3; j++) {
-            if (detector.matriz_requisicao[i][j] > 0) esperando = true;
-            if (detector.matriz_alocacao[i][j] > 0) tem_recursos = true;
-        }
-        
-        if (esperando && tem_recursos) {
-            avioes_esperando++;
+// ------------------------- VERIFICACAO PERIODICA -------------------------
+
+// O retrato acompanha a capacidade do grafo vivo. So a thread que verifica
+// mexe nele, entao cresce sem nenhum mutex.
+static void expandir_retrato(int capacidade) {
+    retrato_alocacao_t* retrato = &detector.retrato;
+    int antigos = retrato->grafo.capacidade;
+    expandir_grafo(&retrato->grafo, capacidade);
+    retrato->avioes = expandir(retrato->avioes, sizeof(aviao_t*), antigos, capacidade, 0);
+    retrato->verificados = expandir(retrato->verificados, sizeof(int), antigos, capacidade, 0);
+    retrato->soltos = expandir(retrato->soltos, sizeof(int), antigos, capacidade, 0);
+    retrato->confirmado = expandir(retrato->confirmado, sizeof(unsigned int), antigos, capacidade, 0);
+    retrato->a_avisar = expandir(retrato->a_avisar, sizeof(int), antigos, capacidade, 0);
+    retrato->avisar = expandir(retrato->avisar, sizeof(aviao_t*), antigos, capacidade, 0);
+    retrato->ids_avisar = expandir(retrato->ids_avisar, sizeof(int), antigos, capacidade, 0);
+    retrato->custos = expandir(retrato->custos, sizeof(double), antigos, capacidade, 0);
+    retrato->aguardados = expandir(retrato->aguardados, sizeof(int), antigos, capacidade, 0);
+    retrato->grupos = expandir(retrato->grupos, sizeof(int), antigos, capacidade, 0);
+    retrato->desfeitos = expandir(retrato->desfeitos, sizeof(bool), antigos, capacidade, 0);
+    retrato->vitimas = expandir(retrato->vitimas, sizeof(aviao_t*), antigos, capacidade, 0);
+    retrato->ids_vitimas = expandir(retrato->ids_vitimas, sizeof(int), antigos, capacidade, 0);
+    retrato->herdeiros = expandir(retrato->herdeiros, 3 * sizeof(aviao_t*), antigos, capacidade, 0);
+    retrato->ids_herdeiros = expandir(retrato->ids_herdeiros, 3 * sizeof(int), antigos, capacidade, 0);
+    retrato->versao = 0;
+}
+
+// Chamada com detector.mutex travado e o retrato do tamanho do grafo vivo.
+// Se nenhuma aresta mudou desde a ultima copia, o retrato ainda vale e so a
+// lista de pendentes e copiada.
+static void tirar_retrato() {
+    retrato_alocacao_t* retrato = &detector.retrato;
+    grafo_alocacao_t* vivo = &detector.grafo;
+    grafo_alocacao_t* copia = &retrato->grafo;
+
+    if (retrato->versao != detector.versao) {
+        memcpy(copia->recursos_disponiveis, vivo->recursos_disponiveis, sizeof(vivo->recursos_disponiveis));
+        memcpy(copia->num_detentores, vivo->num_detentores, sizeof(vivo->num_detentores));
+        for (int r = 0; r < 3; r++) {
+            memcpy(copia->posse[r], vivo->posse[r], vivo->palavras * sizeof(uint64_t));
+            memcpy(copia->espera[r], vivo->espera[r], vivo->palavras * sizeof(uint64_t));
+            memcpy(copia->detentores[r], vivo->detentores[r], vivo->num_detentores[r] * sizeof(int));
         }
+        memcpy(retrato->avioes, detector.avioes, vivo->capacidade * sizeof(aviao_t*));
+        retrato->versao = detector.versao;
+        retrato->copias++;
     }
-    
-    if (avioes_esperando >= 2) {
-        for (int j = 0; j < 3; j++) {
-            if (detector.recursos_disponiveis[j] == 0) {
-                recursos_bloqueados++;
-            }
+    memcpy(retrato->verificados, detector.pendentes, detector.num_pendentes * sizeof(int));
+    retrato->num_verificados = detector.num_pendentes;
+}
+
+// Sem nenhum mutex: so a thread que verifica usa o retrato. Um pendente que
+// apareceu no impasse de outro ja esta confirmado e nao precisa de busca.
+// Os membros de cada impasse encontrado formam um grupo em a_avisar.
+static void analisar_retrato(unsigned int rodada) {
+    retrato_alocacao_t* retrato = &detector.retrato;
+    grafo_alocacao_t* grafo = &retrato->grafo;
+
+    // Todo impasse tem alguem segurando e esperando: sem nenhum, todos os
+    // pendentes caem sem busca.
+    bool possivel = contar_retencao_espera(grafo) > 0;
+    retrato->num_a_avisar = 0;
+    retrato->num_grupos = 0;
+    for (int i = 0; possivel && i < retrato->num_verificados; i++) {
+        int slot = retrato->verificados[i];
+        if (retrato->confirmado[slot] == rodada || aguardado(grafo, slot) < 0) continue;
+        int em_impasse = analisar(grafo, slot);
+        retrato->grupos[retrato->num_grupos++] = retrato->num_a_avisar;
+        for (int j = 0; j < em_impasse; j++) {
+            int membro = grafo->impasse[j];
+            if (retrato->confirmado[membro] == rodada) continue;
+            retrato->confirmado[membro] = rodada;
+            if (segura_algo(grafo, membro)) retrato->a_avisar[retrato->num_a_avisar++] = membro;
         }
-        
-        if (recursos_bloqueados >= 2) {
-            deadlock_detectado = true;
+    }
+}
+
+// Custo de escolher o aviao como vitima, em pontos de prioridade: as
+// unidades que ele perde e tera de pedir de novo, o quanto ja avancou no
+// ciclo (idade) e a prioridade da sua classe. O menor custo de cada impasse,
+// entre os que ja tem os avisos, e o escolhido. Calculado sobre o retrato.
+#define CUSTO_POR_UNIDADE   10.0
+#define CUSTO_POR_SEGUNDO   1.0
+
+static double custo_vitima(const aviao_t* aviao, int slot, double agora) {
+    const grafo_alocacao_t* grafo = &detector.retrato.grafo;
+    int unidades = tem_bit(grafo->posse[0], slot) + tem_bit(grafo->posse[1], slot) + tem_bit(grafo->posse[2], slot);
+    return CUSTO_POR_UNIDADE * unidades + CUSTO_POR_SEGUNDO * (agora - aviao->tempo_de_criacao) +
+           classes_voo[aviao->tipo].prioridade_base;
+}
+
+// Revalida os impasses ja encontrados: prazos de falha e realocacoes podem
+// te-los desfeito. Cada aviao ainda em impasse que segura recursos recebe um
+// aviso por rodada; quem so espera nao tem o que realocar.
+void verificar_deadlock() {
+    retrato_alocacao_t* retrato = &detector.retrato;
+
+    pthread_mutex_lock(&detector.mutex);
+    if (detector.num_pendentes == 0) {
+        pthread_mutex_unlock(&detector.mutex);
+        return;
+    }
+    while (retrato->grafo.capacidade < detector.capacidade) {
+        int capacidade = detector.capacidade;
+        pthread_mutex_unlock(&detector.mutex);
+        expandir_retrato(capacidade);
+        pthread_mutex_lock(&detector.mutex);
+    }
+    double travado = relogio_real();
+    tirar_retrato();
+    unsigned int rodada = ++detector.verificacao_atual;
+    detector.verificacoes++;
+    travado = relogio_real() - travado;
+    pthread_mutex_unlock(&detector.mutex);
+    if (travado > retrato->maior_trava) retrato->maior_trava = travado;
+
+    analisar_retrato(rodada);
+
+    // Ainda sem mutex, cada membro recebe aviao, espera e custo da copia. Um
+    // registro reaproveitado depois dela passou por detector_esquecer_aviao
+    // e muda a versao do slot: o impasse dele e descartado abaixo.
+    double agora = relogio_agora();
+    for (int i = 0; i < retrato->num_a_avisar; i++) {
+        int slot = retrato->a_avisar[i];
+        aviao_t* aviao = retrato->avioes[slot];
+        retrato->avisar[i] = aviao;
+        if (aviao == NULL) continue;
+        retrato->ids_avisar[i] = atomic_load_explicit(&aviao->ID, memory_order_acquire);
+        retrato->aguardados[i] = aguardado(&retrato->grafo, slot);
+        retrato->custos[i] = custo_vitima(aviao, slot, agora);
+    }
+
+    // Os pendentes copiados que seguem em impasse ficam no inicio de
+    // verificados; os outros vao para soltos.
+    int confirmados = 0;
+    retrato->num_soltos = 0;
+    for (int i = 0; i < retrato->num_verificados; i++) {
+        int slot = retrato->verificados[i];
+        if (retrato->confirmado[slot] == rodada) retrato->verificados[confirmados++] = slot;
+        else retrato->soltos[retrato->num_soltos++] = slot;
+    }
+
+    // Com o mutex, so o que depende do grafo vivo: os pendentes copiados
+    // ainda sao o inicio de detector.pendentes (so esta thread os retira) e
+    // quem entrou depois da copia fica para a proxima rodada, assim como um
+    // solto marcado de novo. Se o grafo mudou, um impasse com algum slot
+    // alterado depois da copia e desfeito nesta rodada; seus membros seguem
+    // pendentes.
+    pthread_mutex_lock(&detector.mutex);
+    travado = relogio_real();
+    int novos = detector.num_pendentes - retrato->num_verificados;
+    memmove(detector.pendentes + confirmados, detector.pendentes + retrato->num_verificados, novos * sizeof(int));
+    memcpy(detector.pendentes, retrato->verificados, confirmados * sizeof(int));
+    int restantes = confirmados + novos;
+    for (int i = 0; i < retrato->num_soltos; i++) {
+        int slot = retrato->soltos[i];
+        if (detector.pendente_desde[slot] > retrato->versao) detector.pendentes[restantes++] = slot;
+        else detector.pendente_desde[slot] = 0;
+    }
+    detector.num_pendentes = restantes;
+
+    bool mudou = detector.versao != retrato->versao;
+    for (int g = 0; g < retrato->num_grupos; g++) {
+        int fim = g + 1 < retrato->num_grupos ? retrato->grupos[g + 1] : retrato->num_a_avisar;
+        retrato->desfeitos[g] = false;
+        for (int i = retrato->grupos[g]; mudou && i < fim && !retrato->desfeitos[g]; i++) {
+            retrato->desfeitos[g] = detector.versao_slot[retrato->a_avisar[i]] > retrato->versao;
         }
     }
-    
+    travado = relogio_real() - travado;
     pthread_mutex_unlock(&detector.mutex);
-    return deadlock_detectado;
+    if (travado > retrato->maior_trava) retrato->maior_trava = travado;
+
+    // Os impasses que valem ficam juntos em avisar.
+    int avisados = 0, grupos = 0;
+    for (int g = 0; g < retrato->num_grupos; g++) {
+        int inicio = retrato->grupos[g];
+        int fim = g + 1 < retrato->num_grupos ? retrato->grupos[g + 1] : retrato->num_a_avisar;
+        if (retrato->desfeitos[g]) continue;
+        retrato->grupos[grupos++] = avisados;
+        for (int i = inicio; i < fim; i++) {
+            if (retrato->avisar[i] == NULL) continue;
+            retrato->avisar[avisados] = retrato->avisar[i];
+            retrato->ids_avisar[avisados] = retrato->ids_avisar[i];
+            retrato->aguardados[avisados] = retrato->aguardados[i];
+            retrato->custos[avisados++] = retrato->custos[i];
+        }
+    }
+    retrato->num_grupos = grupos;
+    retrato->num_avisar = avisados;
+
+    // Fora do mutex do detector o slot pode ter sido reaproveitado: quem nao
+    // tem mais o ID copiado ja e outro aviao e nao recebe o aviso.
+    pthread_mutex_lock(&mutex_warnings);
+    for (int i = 0; i < avisados; i++) {
+        aviao_t* aviao = retrato->avisar[i];
+        if (atomic_load_explicit(&aviao->ID, memory_order_acquire) != retrato->ids_avisar[i]) continue;
+        aviao->deadlock_warnings++;
+        if (aviao->deadlock_warnings == MAX_DEADLOCK_WARNINGS) {
+            log_evento(LOG_DEADLOCK, NIVEL_AVISO, "[DEADLOCK] Aviao [%03d] atingiu o limite de %d avisos.\n",
+                   aviao->ID, MAX_DEADLOCK_WARNINGS);
+        }
+    }
+    pthread_mutex_unlock(&mutex_warnings);
+
+    if (avisados > 0) {
+        log_evento(LOG_DEADLOCK, NIVEL_INFO, "[DEADLOCK] %d avioes continuam em impasse.\n", avisados);
+        rastro_evento(RASTRO_VERIFICACAO, 0, RECURSO_RASTRO_NENHUM, 0, avisados);
+        realocar_recursos_avioes_warning();
+    }
 }
 
 void* thread_detectar_deadlock(void* arg) {
+    (void)arg;
     while (sistema_ativo) {
-        if (detectar_ciclo_deadlock()) {
-            pthread_mutex_lock(&mutex_contadores);
-            contador_deadlocks++;
-            pthread_mutex_unlock(&mutex_contadores);
-            
-            log_message("[DEADLOCK] Possivel deadlock detectado. Iniciando verificacao.\n");
-            
-            pthread_mutex_lock(&detector.mutex);
-            for (int i = 0; i < MAX_AVIOES; i++) {
-                bool tem_recursos = false, quer_recursos = false;
-                for (int j = 0; j < 3; j++) {
-                    if (detector.matriz_alocacao[i][j] > 0) tem_recursos = true;
-                    if (detector.matriz_requisicao[i][j] > 0) quer_recursos = true;
-                }
-                if (tem_recursos && quer_recursos) {
-                    pthread_mutex_lock(&mutex_warnings);
-                    for (int k = 0; k < num_avioes_warnings; k++) {
-                        if (avioes_com_warnings[k] && avioes_com_warnings[k]->ID == i + 1) {
-                            avioes_com_warnings[k]->deadlock_warnings++;
-                            if (avioes_com_warnings[k]->deadlock_warnings >= MAX_DEADLOCK_WARNINGS) {
-                                log_message("[DEADLOCK] Aviao [%03d] atingiu o limite de %d avisos.\n", 
-                                       avioes_com_warnings[k]->ID, MAX_DEADLOCK_WARNINGS);
-                            }
-                            break;
-                        }
-                    }
-                    pthread_mutex_unlock(&mutex_warnings);
-                }
-            }
-            pthread_mutex_unlock(&detector.mutex);
-            
-            realocar_recursos_avioes_warning();
-        }
-        sleep(5);
+        verificar_deadlock();
+        relogio_dormir(5);
     }
     return NULL;
 }
 
-void adicionar_aviao_warning(aviao_t* aviao) {
+// avioes_com_warnings e um conjunto intrusivo: cada aviao guarda a propria
+// posicao, entao entrar e sair custam O(1) com qualquer numero de avioes.
+void detector_adicionar_warning(aviao_t* aviao) {
     pthread_mutex_lock(&mutex_warnings);
-    bool ja_existe = false;
-    for (int i = 0; i < num_avioes_warnings; i++) {
-        if (avioes_com_warnings[i] && avioes_com_warnings[i]->ID == aviao->ID) {
-            ja_existe = true;
-            break;
+    if (aviao->posicao_warning < 0) {
+        if (num_avioes_warnings == capacidade_avioes_warnings) {
+            int nova = capacidade_avioes_warnings ? capacidade_avioes_warnings * 2 : 256;
+            aviao_t** lista = realloc(avioes_com_warnings, nova * sizeof(aviao_t*));
+            if (lista == NULL) {
+                perror("Falha ao expandir lista de avisos");
+                exit(EXIT_FAILURE);
+            }
+            avioes_com_warnings = lista;
+            capacidade_avioes_warnings = nova;
         }
-    }
-    if (!ja_existe && num_avioes_warnings < MAX_AVIOES) {
+        aviao->posicao_warning = num_avioes_warnings;
         avioes_com_warnings[num_avioes_warnings++] = aviao;
     }
     pthread_mutex_unlock(&mutex_warnings);
 }
 
+// Chamada com mutex_warnings travado.
+static void tirar_da_lista(aviao_t* aviao) {
+    int posicao = aviao->posicao_warning;
+    if (posicao < 0) return;
+    aviao_t* ultimo = avioes_com_warnings[--num_avioes_warnings];
+    avioes_com_warnings[posicao] = ultimo;
+    ultimo->posicao_warning = posicao;
+    aviao->posicao_warning = -1;
+}
+
+// O slot do aviao vai ser reaproveitado: ele nao pode continuar na lista.
+void remover_aviao_warning(aviao_t* aviao) {
+    pthread_mutex_lock(&mutex_warnings);
+    tirar_da_lista(aviao);
+    pthread_mutex_unlock(&mutex_warnings);
+}
+
 bool aviao_tem_muitos_warnings(aviao_t* aviao) {
     return aviao->deadlock_warnings >= MAX_DEADLOCK_WARNINGS;
 }
 
+// Interrompe, em cada impasse da ultima verificacao, a espera do membro de
+// menor custo entre os que ja somam MAX_DEADLOCK_WARNINGS avisos: o impasse
+// persistiu por tantas verificacoes. Cada vitima devolve sozinha o que segura
+// (veja recurso_interromper); aqui nada e devolvido. Chamada so pela thread
+// que verifica, sem nenhum mutex do detector; o custo e o numero de avisados,
+// nao o de avioes.
 void realocar_recursos_avioes_warning() {
+    retrato_alocacao_t* retrato = &detector.retrato;
+    int num_vitimas = 0;
+
+    // A vitima volta para a lista quando pedir de novo. O ID vem antes de
+    // tudo: de um registro reaproveitado nao se le nem se tira nada.
     pthread_mutex_lock(&mutex_warnings);
-    
-    for (int i = 0; i < num_avioes_warnings; i++) {
-        aviao_t* aviao = avioes_com_warnings[i];
-        if (aviao && aviao_tem_muitos_warnings(aviao) && !aviao->recursos_realocados) {
-            log_message("[DEADLOCK] Realocando recursos do Aviao [%03d] para resolver o impasse.\n", aviao->ID);
-            
-            pthread_mutex_lock(&detector.mutex);
-            for (int j = 0; j < 3; j++) {
-                if (detector.matriz_alocacao[aviao->ID - 1][j] > 0) {
-                    detector.matriz_alocacao[aviao->ID - 1][j] = 0;
-                    detector.recursos_disponiveis[j]++;
-                    aviao->recursos_alocados[j] = 0;
-                    
-                    if (j == 0) sem_post(&sem_pistas);
-                    else if (j == 1) sem_post(&sem_portoes);
-                    else if (j == 2) sem_post(&sem_torre_ops);
-                }
-            }
-            pthread_mutex_unlock(&detector.mutex);
-            
-            aviao->recursos_realocados = true;
-            pthread_mutex_lock(&mutex_contadores);
-            recursos_realocados++;
-            pthread_mutex_unlock(&mutex_contadores);
-            
-            avioes_com_warnings[i] = NULL;
+    for (int g = 0; g < retrato->num_grupos; g++) {
+        int fim = g + 1 < retrato->num_grupos ? retrato->grupos[g + 1] : retrato->num_avisar;
+        int vitima = -1;
+        for (int i = retrato->grupos[g]; i < fim; i++) {
+            aviao_t* aviao = retrato->avisar[i];
+            if (atomic_load_explicit(&aviao->ID, memory_order_acquire) != retrato->ids_avisar[i]) continue;
+            if (aviao->posicao_warning < 0 || !aviao_tem_muitos_warnings(aviao)) continue;
+            if (vitima < 0 || retrato->custos[i] < retrato->custos[vitima]) vitima = i;
         }
-    }
-    
-    int nova_pos = 0;
-    for (int i = 0; i < num_avioes_warnings; i++) {
-        if (avioes_com_warnings[i] != NULL) {
-            avioes_com_warnings[nova_pos++] = avioes_com_warnings[i];
+        if (vitima < 0) continue;
+        tirar_da_lista(retrato->avisar[vitima]);
+        retrato->vitimas[num_vitimas] = retrato->avisar[vitima];
+        retrato->ids_vitimas[num_vitimas] = retrato->ids_avisar[vitima];
+
+        // O que a vitima devolver vai para o primeiro do mesmo impasse que o
+        // aguarda: pela fila iria ao cabeca, em geral outro aviao da mesma
+        // rota, e o impasse se formaria de novo.
+        aviao_t** herdeiros = &retrato->herdeiros[3 * num_vitimas];
+        int* ids_herdeiros = &retrato->ids_herdeiros[3 * num_vitimas++];
+        memset(herdeiros, 0, 3 * sizeof(aviao_t*));
+        for (int i = retrato->grupos[g]; i < fim; i++) {
+            int r = retrato->aguardados[i];
+            if (i == vitima || r < 0 || herdeiros[r] != NULL) continue;
+            if (atomic_load_explicit(&retrato->avisar[i]->ID, memory_order_acquire) != retrato->ids_avisar[i]) continue;
+            herdeiros[r] = retrato->avisar[i];
+            ids_herdeiros[r] = retrato->ids_avisar[i];
         }
     }
-    num_avioes_warnings = nova_pos;
-    
     pthread_mutex_unlock(&mutex_warnings);
-}
\ No newline at end of file
+
+    for (int i = 0; i < num_vitimas; i++) {
+        if (!recurso_interromper(retrato->vitimas[i], retrato->ids_vitimas[i], &retrato->herdeiros[3 * i],
+                                 &retrato->ids_herdeiros[3 * i])) continue;
+        log_evento(LOG_DEADLOCK, NIVEL_AVISO, "[DEADLOCK] Aviao [%03d] escolhido como vitima do impasse: sua espera foi interrompida.\n",
+               retrato->ids_vitimas[i]);
+        rastro_evento(RASTRO_REALOCACAO, retrato->ids_vitimas[i], RECURSO_RASTRO_NENHUM,
+                      prioridade_base_do_aviao(retrato->vitimas[i]), num_vitimas);
+        pthread_mutex_lock(&mutex_contadores);
+        recursos_realocados++;
+        pthread_mutex_unlock(&mutex_contadores);
+    }
+}
+
+#endif
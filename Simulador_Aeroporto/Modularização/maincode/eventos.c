@@ -0,0 +1,471 @@
+#include "aeroporto.h"
+
+// ----------------------- MOTOR DE EVENTOS DISCRETOS -----------------------
+// Executa o mesmo ciclo pouso/desembarque/decolagem do motor de threads em
+// uma unica thread. Cada acao vira um evento no calendario e o relogio
+// virtual salta direto para o proximo evento, sem nenhum sleep real.
+
+typedef enum {
+    EV_CHEGADA,
+    EV_SOLICITAR,
+    EV_FIM_OPERACAO,
+    EV_LIBERAR_PORTAO,
+    EV_PRAZO_BONUS,
+    EV_PRAZO_ALERTA,
+    EV_PRAZO_FALHA,
+    EV_PREEMPCAO,
+    EV_DETECTOR
+} tipo_evento;
+
+typedef struct {
+    aviao_t aviao;              // primeiro campo: a fila guarda aviao_t*
+    tipo_operacao operacao;
+    int passo;
+    bool esperando;
+    tipo_recurso recurso_aguardado;
+    double inicio_espera;
+    unsigned long ticket;
+} aviao_evento_t;
+
+typedef struct {
+    double tempo;
+    unsigned long seq;
+    tipo_evento tipo;
+    aviao_evento_t* av;
+    unsigned long ticket;
+} evento_t;
+
+typedef struct {
+    evento_t* itens;
+    size_t tamanho;
+    size_t capacidade;
+    unsigned long proximo_seq;
+} calendario_t;
+
+static calendario_t calendario;
+static int contador_avioes = 0;
+static int avioes_ativos = 0;
+
+// ------------------------------ CALENDARIO ------------------------------
+static bool evento_antes(const evento_t* a, const evento_t* b) {
+    if (a->tempo != b->tempo) return a->tempo < b->tempo;
+    return a->seq < b->seq;
+}
+
+static void agendar(double tempo, tipo_evento tipo, aviao_evento_t* av, unsigned long ticket) {
+    if (calendario.tamanho == calendario.capacidade) {
+        size_t nova = calendario.capacidade ? calendario.capacidade * 2 : 256;
+        evento_t* itens = realloc(calendario.itens, nova * sizeof(evento_t));
+        if (itens == NULL) {
+            perror("Falha ao expandir o calendario de eventos");
+            exit(EXIT_FAILURE);
+        }
+        calendario.itens = itens;
+        calendario.capacidade = nova;
+    }
+
+    evento_t ev = { tempo, calendario.proximo_seq++, tipo, av, ticket };
+    size_t i = calendario.tamanho++;
+    while (i > 0) {
+        size_t pai = (i - 1) / 2;
+        if (!evento_antes(&ev, &calendario.itens[pai])) break;
+        calendario.itens[i] = calendario.itens[pai];
+        i = pai;
+    }
+    calendario.itens[i] = ev;
+}
+
+static evento_t retirar_proximo() {
+    evento_t topo = calendario.itens[0];
+    evento_t ultimo = calendario.itens[--calendario.tamanho];
+    size_t i = 0;
+
+    while (1) {
+        size_t filho = 2 * i + 1;
+        if (filho >= calendario.tamanho) break;
+        if (filho + 1 < calendario.tamanho && evento_antes(&calendario.itens[filho + 1], &calendario.itens[filho])) {
+            filho++;
+        }
+        if (!evento_antes(&calendario.itens[filho], &ultimo)) break;
+        calendario.itens[i] = calendario.itens[filho];
+        i = filho;
+    }
+    if (calendario.tamanho > 0) {
+        calendario.itens[i] = ultimo;
+    }
+    return topo;
+}
+
+// ------------------------------- RECURSOS -------------------------------
+static void mudar_estado(aviao_evento_t* av, estado_aviao estado) {
+    pthread_mutex_lock(&mutex_lista_avioes);
+    av->aviao.estado = estado;
+    pthread_mutex_unlock(&mutex_lista_avioes);
+}
+
+static const char* nome_aguardado(const aviao_evento_t* av) {
+    if (config.aquisicao == AQUISICAO_CONJUNTO) return RECURSOS_OPERACAO[av->operacao];
+    return nome_do_recurso(av->recurso_aguardado);
+}
+
+static int recurso_aguardado_rastro(const aviao_evento_t* av) {
+    if (config.aquisicao == AQUISICAO_CONJUNTO) return RECURSO_RASTRO_NENHUM;
+    return av->recurso_aguardado;
+}
+
+static void registrar_posse(aviao_evento_t* av, tipo_recurso recurso) {
+    limpar_requisicao(&av->aviao, recurso);
+    registrar_alocacao(&av->aviao, recurso);
+    log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] alocou %s com sucesso.\n",
+           av->aviao.ID, nome_do_recurso(recurso));
+    rastrear(RASTRO_CONCESSAO, &av->aviao, recurso, 0);
+}
+
+static void operacao_abastecida(aviao_evento_t* av) {
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Obteve todos os recursos para %s.\n",
+           av->aviao.ID, RECURSOS_OPERACAO[av->operacao]);
+    log_evento(LOG_AVIAO, NIVEL_INFO, MENSAGEM_ANDAMENTO[av->operacao], av->aviao.ID);
+    agendar(relogio_agora() + DURACAO_OPERACAO[av->operacao], EV_FIM_OPERACAO, av, av->ticket);
+}
+
+// O aviao recebeu a unidade, na hora ou por repasse de quem liberou.
+static void concedido(aviao_evento_t* av, tipo_recurso recurso) {
+    registrar_posse(av, recurso);
+
+    av->esperando = false;
+    av->ticket++;
+    av->passo++;
+
+    if (av->passo < NUM_PASSOS_OPERACAO[av->operacao]) {
+        agendar(relogio_agora(), EV_SOLICITAR, av, av->ticket);
+    } else {
+        operacao_abastecida(av);
+    }
+}
+
+// O aviao recebeu de uma vez todos os recursos da operacao.
+static void conjunto_concedido(aviao_evento_t* av) {
+    for (int r = 0; r < 3; r++) {
+        if (CONJUNTO_OPERACAO[av->operacao] & (1 << r)) registrar_posse(av, (tipo_recurso)r);
+    }
+
+    av->esperando = false;
+    av->ticket++;
+    av->passo = NUM_PASSOS_OPERACAO[av->operacao];
+    operacao_abastecida(av);
+}
+
+static bool repasse_concedido(request_node_t* no) {
+    if (no->recursos != 0) {
+        conjunto_concedido((aviao_evento_t*)no->aviao);
+    } else {
+        concedido((aviao_evento_t*)no->aviao, no->recurso_desejado);
+    }
+    return true;
+}
+
+// O detector tirou o aviao da fila. A devolucao fica para um evento proprio:
+// aqui o mutex da fila esta travado.
+static bool preempcao_pedida(request_node_t* no) {
+    aviao_evento_t* av = (aviao_evento_t*)no->aviao;
+    if (!av->esperando) return false;
+
+    av->esperando = false;
+    av->ticket++;
+    agendar(relogio_agora(), EV_PREEMPCAO, av, av->ticket);
+    return true;
+}
+
+static void liberar(aviao_evento_t* av, tipo_recurso recurso) {
+    registrar_liberacao(&av->aviao, recurso);
+    liberar_recurso_com_prioridade(recurso_do_tipo(recurso), &av->aviao);
+}
+
+// ------------------------------ CICLO DO AVIAO ------------------------------
+static void iniciar_espera(aviao_evento_t* av) {
+    double agora = relogio_agora();
+
+    adicionar_aviao_warning(&av->aviao);
+    av->esperando = true;
+    av->inicio_espera = agora;
+    av->ticket++;
+    agendar(agora + config.limiar_bonus, EV_PRAZO_BONUS, av, av->ticket);
+    agendar(agora + ALERTA_CRITICO, EV_PRAZO_ALERTA, av, av->ticket);
+    agendar(agora + FALHA, EV_PRAZO_FALHA, av, av->ticket);
+}
+
+static void solicitar_proximo_recurso(aviao_evento_t* av) {
+    tipo_recurso recurso = ORDEM_RECURSOS[av->operacao][av->aviao.rota][av->passo];
+
+    log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] solicitou %s.\n",
+           av->aviao.ID, nome_do_recurso(recurso));
+    rastrear(RASTRO_PEDIDO, &av->aviao, recurso, 0);
+    if (av->aviao.recursos_realocados && av->aviao.tipo == DOMESTICO) {
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Aviao [%03d] (domestico realocado) tem prioridade maxima.\n",
+               av->aviao.ID);
+    }
+
+    registrar_requisicao(&av->aviao, recurso);
+    av->recurso_aguardado = recurso;
+    iniciar_espera(av);
+
+    int resultado = recurso_solicitar(recurso_do_tipo(recurso), &av->aviao);
+    if (resultado == -1) {
+        perror("Falha ao alocar requisicao");
+        exit(EXIT_FAILURE);
+    }
+    if (resultado == 1) {
+        concedido(av, recurso);
+    }
+}
+
+// --aquisicao=conjunto: a operacao inteira em um pedido.
+static void solicitar_conjunto(aviao_evento_t* av) {
+    int recursos = CONJUNTO_OPERACAO[av->operacao];
+
+    log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] solicitou %s.\n",
+           av->aviao.ID, RECURSOS_OPERACAO[av->operacao]);
+    if (av->aviao.recursos_realocados && av->aviao.tipo == DOMESTICO) {
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Aviao [%03d] (domestico realocado) tem prioridade maxima.\n",
+               av->aviao.ID);
+    }
+
+    for (int r = 0; r < 3; r++) {
+        if (!(recursos & (1 << r))) continue;
+        registrar_requisicao(&av->aviao, (tipo_recurso)r);
+        rastrear(RASTRO_PEDIDO, &av->aviao, r, 0);
+    }
+    iniciar_espera(av);
+
+    int resultado = conjunto_solicitar(&av->aviao, recursos);
+    if (resultado == -1) {
+        perror("Falha ao alocar requisicao");
+        exit(EXIT_FAILURE);
+    }
+    if (resultado == 1) {
+        conjunto_concedido(av);
+    }
+}
+
+static void iniciar_operacao(aviao_evento_t* av, tipo_operacao operacao) {
+    static const estado_aviao ESTADOS[3] = { POUSANDO, DESEMBARCANDO, DECOLANDO };
+
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Iniciando procedimento de %s.\n",
+           av->aviao.ID, NOME_OPERACAO[operacao]);
+    mudar_estado(av, ESTADOS[operacao]);
+    av->operacao = operacao;
+    av->passo = 0;
+    if (config.aquisicao == AQUISICAO_CONJUNTO) {
+        solicitar_conjunto(av);
+    } else {
+        banqueiro_declarar(&av->aviao, CONJUNTO_OPERACAO[operacao]);
+        solicitar_proximo_recurso(av);
+    }
+}
+
+static void fim_operacao(aviao_evento_t* av) {
+    switch (av->operacao) {
+        case OP_POUSO:
+            liberar(av, RECURSO_PISTA);
+            liberar(av, RECURSO_TORRE);
+            log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Pouso concluido. Recursos liberados.\n", av->aviao.ID);
+            iniciar_operacao(av, OP_DESEMBARQUE);
+            break;
+        case OP_DESEMBARQUE:
+            liberar(av, RECURSO_TORRE);
+            agendar(relogio_agora() + 2, EV_LIBERAR_PORTAO, av, av->ticket);
+            break;
+        case OP_DECOLAGEM:
+            liberar(av, RECURSO_PORTAO);
+            liberar(av, RECURSO_PISTA);
+            liberar(av, RECURSO_TORRE);
+            log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Decolagem concluida. Recursos liberados.\n", av->aviao.ID);
+            mudar_estado(av, CONCLUIDO);
+            log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Todas as operacoes foram concluidas com sucesso.\n",
+                   av->aviao.ID);
+            avioes_ativos--;
+            aviao_finalizado(&av->aviao);
+            break;
+    }
+}
+
+static void prazo_alerta(aviao_evento_t* av, unsigned long ticket) {
+    if (!av->esperando || av->ticket != ticket || av->aviao.em_alerta) return;
+
+    pthread_mutex_lock(&mutex_lista_avioes);
+    av->aviao.em_alerta = true;
+    pthread_mutex_unlock(&mutex_lista_avioes);
+
+    log_evento(LOG_ALERTA, NIVEL_AVISO, "[ALERTA] Aviao [%03d] em situacao critica esperando por %s (tempo: %lds).\n",
+           av->aviao.ID, nome_aguardado(av), (long)(relogio_agora() - av->inicio_espera));
+    rastrear(RASTRO_ALERTA, &av->aviao, recurso_aguardado_rastro(av),
+             (int)(relogio_agora() - av->inicio_espera));
+}
+
+static void prazo_falha(aviao_evento_t* av, unsigned long ticket) {
+    if (!av->esperando || av->ticket != ticket) return;
+
+    av->esperando = false;
+    av->ticket++;
+    mudar_estado(av, FALHA_OPERACIONAL);
+
+    pthread_mutex_lock(&mutex_contadores);
+    contador_starvation++;
+    pthread_mutex_unlock(&mutex_contadores);
+
+    if (config.aquisicao == AQUISICAO_CONJUNTO) {
+        conjunto_desistir(&av->aviao);
+        for (int r = 0; r < 3; r++) {
+            if (CONJUNTO_OPERACAO[av->operacao] & (1 << r)) limpar_requisicao(&av->aviao, (tipo_recurso)r);
+        }
+    } else {
+        remover_requisicao(fila_do_recurso(av->recurso_aguardado), &av->aviao);
+        limpar_requisicao(&av->aviao, av->recurso_aguardado);
+    }
+
+    log_evento(LOG_ALERTA, NIVEL_ERRO, "[ALERTA] FALHA OPERACIONAL POR STARVATION: Aviao [%03d] excedeu tempo limite esperando por %s (%lds).\n",
+           av->aviao.ID, nome_aguardado(av), (long)(relogio_agora() - av->inicio_espera));
+    rastrear(RASTRO_FALHA, &av->aviao, recurso_aguardado_rastro(av),
+             (int)(relogio_agora() - av->inicio_espera));
+
+    // Devolve o que ja tinha sido obtido nesta operacao, como em solicitar_pouso & cia.
+    for (int i = av->passo - 1; i >= 0; i--) {
+        liberar(av, ORDEM_RECURSOS[av->operacao][av->aviao.rota][i]);
+    }
+    banqueiro_encerrar(&av->aviao);
+    log_evento(LOG_AVIAO, NIVEL_AVISO, "[AVIAO %03d] Falha ao obter recursos para %s. Abortando.\n",
+           av->aviao.ID, NOME_OPERACAO[av->operacao]);
+    avioes_ativos--;
+    aviao_finalizado(&av->aviao);
+}
+
+// Vitima de um impasse: devolve o que obteve na operacao e recomeca do
+// primeiro passo, como solicitar_operacao.
+static void preemptado(aviao_evento_t* av) {
+    limpar_requisicao(&av->aviao, av->recurso_aguardado);
+    for (int i = av->passo - 1; i >= 0; i--) {
+        liberar(av, ORDEM_RECURSOS[av->operacao][av->aviao.rota][i]);
+    }
+    aviao_preemptado(&av->aviao, av->operacao);
+    av->passo = 0;
+    solicitar_proximo_recurso(av);
+}
+
+static void encerrar_chegadas(bool limite_atingido) {
+    sistema_ativo = false;
+    fila_encerrar_envelhecimento();
+    if (!limite_atingido)
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "\n[SISTEMA] TEMPO ESGOTADO! Nenhum aviao novo sera criado. Aguardando existentes...\n");
+    else
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "\n[SISTEMA] LIMITE DE AVIOES ATINGIDO! Aguardando existentes...\n");
+}
+
+static void chegada() {
+    double agora = relogio_agora();
+
+    if (agora >= TEMPO_TOTAL) {
+        encerrar_chegadas(false);
+        return;
+    }
+
+    // Slot reaproveitado mantem o ticket: prazos agendados para o aviao
+    // anterior continuam sendo descartados.
+    aviao_evento_t* av = (aviao_evento_t*)registro_obter();
+    if (av == NULL) {
+        perror("Falha ao alocar memoria para o aviao");
+        exit(EXIT_FAILURE);
+    }
+    inicializar_aviao(&av->aviao, ++contador_avioes);
+    avioes_ativos++;
+
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Criado (%s), aproximando-se do aeroporto.\n",
+           av->aviao.ID, classes_voo[av->aviao.tipo].nome);
+    iniciar_operacao(av, OP_POUSO);
+
+    if (config.max_avioes > 0 && contador_avioes == config.max_avioes) {
+        encerrar_chegadas(true);
+        return;
+    }
+    agendar(agora + intervalo_chegada(), EV_CHEGADA, NULL, 0);
+}
+
+static void despachar(const evento_t* ev) {
+    switch (ev->tipo) {
+        case EV_CHEGADA:
+            chegada();
+            break;
+        case EV_SOLICITAR:
+            solicitar_proximo_recurso(ev->av);
+            break;
+        case EV_FIM_OPERACAO:
+            fim_operacao(ev->av);
+            break;
+        case EV_LIBERAR_PORTAO:
+            liberar(ev->av, RECURSO_PORTAO);
+            log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Desembarque concluido. Recursos liberados.\n",
+                   ev->av->aviao.ID);
+            iniciar_operacao(ev->av, OP_DECOLAGEM);
+            break;
+        case EV_PRAZO_BONUS:
+            if (!ev->av->esperando || ev->av->ticket != ev->ticket) break;
+            if (config.aquisicao == AQUISICAO_CONJUNTO) {
+                conjunto_aplicar_bonus(&ev->av->aviao);
+            } else {
+                fila_aplicar_bonus(fila_do_recurso(ev->av->recurso_aguardado), &ev->av->aviao, ev->av->recurso_aguardado);
+            }
+            break;
+        case EV_PRAZO_ALERTA:
+            prazo_alerta(ev->av, ev->ticket);
+            break;
+        case EV_PRAZO_FALHA:
+            prazo_falha(ev->av, ev->ticket);
+            break;
+        case EV_PREEMPCAO:
+            if (ev->av->ticket == ev->ticket) preemptado(ev->av);
+            break;
+        case EV_DETECTOR:
+            if (!sistema_ativo) break;
+            verificar_deadlock();
+            agendar(relogio_agora() + 5, EV_DETECTOR, NULL, 0);
+            break;
+    }
+}
+
+int executar_motor_eventos() {
+    registro_iniciar(sizeof(aviao_evento_t));
+    definir_tratador_concessao(repasse_concedido);
+    definir_tratador_preempcao(preempcao_pedida);
+    contador_avioes = 0;
+    avioes_ativos = 0;
+
+    agendar(0, EV_CHEGADA, NULL, 0);
+    if (DETECTOR_ATIVO) {
+        agendar(0, EV_DETECTOR, NULL, 0);
+    }
+
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "\n[SISTEMA] --- SIMULACAO INICIADA ---\n\n");
+
+    double inicio_real = relogio_real();
+    unsigned long eventos_processados = 0;
+
+    while (calendario.tamanho > 0) {
+        evento_t ev = retirar_proximo();
+        relogio_avancar(ev.tempo);
+        despachar(&ev);
+        eventos_processados++;
+    }
+
+    double duracao_real = relogio_real() - inicio_real;
+    double tempo_simulado = relogio_agora();
+
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "\n[SISTEMA] Motor de eventos: %lu eventos em %.3fs reais (%.0f eventos/s).\n",
+           eventos_processados, duracao_real, duracao_real > 0 ? eventos_processados / duracao_real : 0.0);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Tempo simulado: %.1fs (%.0fx mais rapido que o tempo real). Avioes pendentes: %d.\n",
+           tempo_simulado, duracao_real > 0 ? tempo_simulado / duracao_real : 0.0, avioes_ativos);
+
+    free(calendario.itens);
+    calendario.itens = NULL;
+    calendario.tamanho = calendario.capacidade = 0;
+
+    return contador_avioes;
+}
@@ -0,0 +1,347 @@
+#include "fibra.h"
+#include "relogio.h"
+#include "logger.h"
+#include "temporizador.h"
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#define PILHAS_POR_BLOCO 64
+
+struct fibra {
+    ucontext_t contexto;
+    ucontext_t* retorno;            // contexto da trabalhadora que a esta executando
+    void* pilha;
+    void* (*funcao)(void*);
+    void* arg;
+    _Atomic unsigned long estado;   // (geracao << 1) | estacionada
+    bool expirou;
+    bool finalizada;
+    pthread_mutex_t* mutex_a_liberar;
+    bool tem_prazo;
+    double prazo;
+    fibra_t* proxima;
+};
+
+// Um unico mutex protege a fila de prontas, os temporizadores e os contadores.
+static pthread_mutex_t mutex_escalonador = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_trabalho;
+static pthread_cond_t cond_fim;
+
+static fibra_t* prontas_inicio = NULL;
+static fibra_t* prontas_fim = NULL;
+static agenda_t temporizadores;
+
+static pthread_t* trabalhadoras = NULL;
+static int num_trabalhadoras = 0;
+static size_t tamanho_pilha = 0;
+static void* pilhas_livres = NULL;
+static size_t pilhas_reservadas = 0;
+
+// Fibras terminadas nunca voltam ao malloc: um temporizador antigo ainda pode
+// apontar para elas, e a geracao no estado so protege se a memoria continuar valida.
+static fibra_t* fibras_livres = NULL;
+
+static long fibras_vivas = 0;
+static long fibras_criadas = 0;
+static long pico_fibras = 0;
+static bool encerrando = false;
+
+static __thread fibra_t* fibra_corrente = NULL;
+static __thread ucontext_t contexto_trabalhadora;
+
+// Nao pode ser inline: uma fibra pode voltar a rodar em outra thread e o
+// compilador nao deve reaproveitar o endereco da variavel __thread anterior.
+__attribute__((noinline)) fibra_t* fibra_atual() {
+    return fibra_corrente;
+}
+
+static double prazo_em_segundos(const struct timespec* ts) {
+    return ts->tv_sec + ts->tv_nsec / 1e9;
+}
+
+// ------------------------------- PILHAS -------------------------------
+// As pilhas vem de blocos grandes de mmap (MAP_NORESERVE): a memoria so e
+// ocupada quando tocada e o numero de mapeamentos nao cresce por fibra.
+static void* obter_pilha() {
+    if (pilhas_livres == NULL) {
+        char* bloco = mmap(NULL, tamanho_pilha * PILHAS_POR_BLOCO, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+        if (bloco == MAP_FAILED) {
+            return NULL;
+        }
+        for (int i = 0; i < PILHAS_POR_BLOCO; i++) {
+            void* pilha = bloco + (size_t)i * tamanho_pilha;
+            *(void**)pilha = pilhas_livres;
+            pilhas_livres = pilha;
+        }
+        pilhas_reservadas += PILHAS_POR_BLOCO;
+    }
+    void* pilha = pilhas_livres;
+    pilhas_livres = *(void**)pilha;
+    return pilha;
+}
+
+static void devolver_pilha(void* pilha) {
+    *(void**)pilha = pilhas_livres;
+    pilhas_livres = pilha;
+}
+
+// --------------------------- FILA DE PRONTAS ---------------------------
+static void enfileirar_pronta(fibra_t* f) {
+    f->proxima = NULL;
+    if (prontas_fim) prontas_fim->proxima = f; else prontas_inicio = f;
+    prontas_fim = f;
+    pthread_cond_signal(&cond_trabalho);
+}
+
+static fibra_t* retirar_pronta() {
+    fibra_t* f = prontas_inicio;
+    if (f) {
+        prontas_inicio = f->proxima;
+        if (prontas_inicio == NULL) prontas_fim = NULL;
+    }
+    return f;
+}
+
+// Quem ganhar o CAS (sinal ou temporizador) acorda a fibra; o outro desiste.
+// A geracao no estado impede que um temporizador antigo acorde uma espera nova.
+static bool acordar(fibra_t* f, unsigned long esperado, bool expirou) {
+    if (!atomic_compare_exchange_strong(&f->estado, &esperado, esperado & ~1UL)) {
+        return false;
+    }
+    f->expirou = expirou;
+    return true;
+}
+
+// ---------------------------- TEMPORIZADORES ----------------------------
+static void disparar_temporizadores(double agora) {
+    temporizador_t t;
+    while (agenda_retirar_vencido(&temporizadores, agora, &t)) {
+        fibra_t* f = t.alvo;
+        if (acordar(f, t.marca, true)) {
+            enfileirar_pronta(f);
+        }
+    }
+}
+
+// ------------------------------- EXECUCAO -------------------------------
+static void executar_fibra() {
+    fibra_t* f = fibra_atual();
+    f->funcao(f->arg);
+    f->finalizada = true;
+    swapcontext(&f->contexto, f->retorno);
+}
+
+// Roda a fibra ate ela estacionar ou terminar. O que ela pediu antes de
+// estacionar (prazo, liberar o mutex) so e feito aqui, ja fora da pilha dela,
+// para que ninguem a acorde enquanto ainda esta em execucao.
+static void retomar(fibra_t* f) {
+    fibra_corrente = f;
+    f->retorno = &contexto_trabalhadora;
+    swapcontext(&contexto_trabalhadora, &f->contexto);
+    fibra_corrente = NULL;
+
+    if (f->finalizada) {
+        pthread_mutex_lock(&mutex_escalonador);
+        devolver_pilha(f->pilha);
+        f->proxima = fibras_livres;
+        fibras_livres = f;
+        fibras_vivas--;
+        if (fibras_vivas == 0) {
+            pthread_cond_broadcast(&cond_fim);
+        }
+        pthread_mutex_unlock(&mutex_escalonador);
+        return;
+    }
+
+    pthread_mutex_t* mutex = f->mutex_a_liberar;
+    if (f->tem_prazo) {
+        pthread_mutex_lock(&mutex_escalonador);
+        if (agenda_inserir(&temporizadores, f->prazo, f, atomic_load(&f->estado), 0)) {
+            pthread_cond_signal(&cond_trabalho);
+        }
+        pthread_mutex_unlock(&mutex_escalonador);
+    }
+    if (mutex) {
+        pthread_mutex_unlock(mutex);
+    }
+}
+
+static void* rotina_trabalhadora(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&mutex_escalonador);
+    while (1) {
+        disparar_temporizadores(relogio_real());
+        fibra_t* f = retirar_pronta();
+
+        if (f == NULL) {
+            if (encerrando) break;
+
+            double limite = relogio_real() + 0.05;
+            double proximo;
+            if (agenda_proximo_prazo(&temporizadores, &proximo) && proximo < limite) {
+                limite = proximo;
+            }
+            struct timespec ts;
+            ts.tv_sec = (time_t)limite;
+            ts.tv_nsec = (long)((limite - ts.tv_sec) * 1e9);
+            pthread_cond_timedwait(&cond_trabalho, &mutex_escalonador, &ts);
+            continue;
+        }
+
+        pthread_mutex_unlock(&mutex_escalonador);
+        retomar(f);
+        pthread_mutex_lock(&mutex_escalonador);
+    }
+    pthread_mutex_unlock(&mutex_escalonador);
+    return NULL;
+}
+
+// Estaciona a fibra atual. Se "mutex" for dado, ele e liberado pela
+// trabalhadora depois da troca de contexto, como em pthread_cond_wait.
+static int estacionar(fibra_t* f, pthread_mutex_t* mutex, const struct timespec* prazo) {
+    unsigned long geracao = atomic_load(&f->estado) >> 1;
+
+    f->expirou = false;
+    f->mutex_a_liberar = mutex;
+    f->tem_prazo = prazo != NULL;
+    if (prazo) {
+        f->prazo = prazo_em_segundos(prazo);
+    }
+    atomic_store(&f->estado, ((geracao + 1) << 1) | 1UL);
+    swapcontext(&f->contexto, f->retorno);
+
+    return f->expirou ? ETIMEDOUT : 0;
+}
+
+// ------------------------------ INTERFACE ------------------------------
+void fibras_iniciar(int trabalhadores, size_t pilha) {
+    relogio_iniciar_cond(&cond_trabalho);
+    pthread_cond_init(&cond_fim, NULL);
+    tamanho_pilha = pilha;
+    encerrando = false;
+
+    num_trabalhadoras = trabalhadores > 0 ? trabalhadores : 1;
+    trabalhadoras = malloc(num_trabalhadoras * sizeof(pthread_t));
+    if (trabalhadoras == NULL) {
+        perror("Falha ao alocar trabalhadoras das fibras");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < num_trabalhadoras; i++) {
+        pthread_create(&trabalhadoras[i], NULL, rotina_trabalhadora, NULL);
+    }
+}
+
+int fibra_criar(void* (*funcao)(void*), void* arg) {
+    pthread_mutex_lock(&mutex_escalonador);
+    fibra_t* f = fibras_livres;
+    if (f != NULL) {
+        fibras_livres = f->proxima;
+    } else {
+        f = calloc(1, sizeof(fibra_t));
+        if (f != NULL) atomic_init(&f->estado, 0);
+    }
+    void* pilha = f ? obter_pilha() : NULL;
+    if (f != NULL && pilha == NULL) {
+        f->proxima = fibras_livres;
+        fibras_livres = f;
+    }
+    pthread_mutex_unlock(&mutex_escalonador);
+    if (pilha == NULL) return -1;
+
+    f->pilha = pilha;
+    f->funcao = funcao;
+    f->arg = arg;
+    f->finalizada = false;
+    getcontext(&f->contexto);
+    f->contexto.uc_stack.ss_sp = f->pilha;
+    f->contexto.uc_stack.ss_size = tamanho_pilha;
+    f->contexto.uc_link = NULL;
+    makecontext(&f->contexto, executar_fibra, 0);
+
+    pthread_mutex_lock(&mutex_escalonador);
+    fibras_vivas++;
+    fibras_criadas++;
+    if (fibras_vivas > pico_fibras) pico_fibras = fibras_vivas;
+    enfileirar_pronta(f);
+    pthread_mutex_unlock(&mutex_escalonador);
+    return 0;
+}
+
+void fibras_aguardar() {
+    pthread_mutex_lock(&mutex_escalonador);
+    while (fibras_vivas > 0) {
+        pthread_cond_wait(&cond_fim, &mutex_escalonador);
+    }
+    encerrando = true;
+    pthread_cond_broadcast(&cond_trabalho);
+    pthread_mutex_unlock(&mutex_escalonador);
+
+    for (int i = 0; i < num_trabalhadoras; i++) {
+        pthread_join(trabalhadoras[i], NULL);
+    }
+    free(trabalhadoras);
+    while (fibras_livres != NULL) {
+        fibra_t* f = fibras_livres;
+        fibras_livres = f->proxima;
+        free(f);
+    }
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Fibras: %ld criadas em %d trabalhadoras, pico de %ld simultaneas.\n",
+           fibras_criadas, num_trabalhadoras, pico_fibras);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Temporizadores das fibras: %lu agendados, %lu disparados.\n",
+           temporizadores.inseridos, temporizadores.disparados);
+    agenda_destruir(&temporizadores);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Pilhas de fibra: %zu KB cada, %zu reservadas (%.1f MB de espaco virtual).\n",
+           tamanho_pilha / 1024, pilhas_reservadas, pilhas_reservadas * tamanho_pilha / (1024.0 * 1024.0));
+}
+
+void fibra_dormir(const struct timespec* prazo) {
+    estacionar(fibra_atual(), NULL, prazo);
+}
+
+void espera_iniciar(espera_t* espera) {
+    relogio_iniciar_cond(&espera->cond);
+    espera->fibra = NULL;
+}
+
+void espera_destruir(espera_t* espera) {
+    pthread_cond_destroy(&espera->cond);
+}
+
+// Chamada com "mutex" travado; retorna 0 ou ETIMEDOUT com ele travado de novo.
+int espera_aguardar(espera_t* espera, pthread_mutex_t* mutex, const struct timespec* prazo) {
+    fibra_t* f = fibra_atual();
+    if (f == NULL) {
+        if (prazo == NULL) return pthread_cond_wait(&espera->cond, mutex);
+        return pthread_cond_timedwait(&espera->cond, mutex, prazo);
+    }
+
+    espera->fibra = f;
+    int resultado = estacionar(f, mutex, prazo);
+    pthread_mutex_lock(mutex);
+    if (espera->fibra == f) {
+        espera->fibra = NULL;
+    }
+    return resultado;
+}
+
+// Chamada com o mesmo mutex usado por quem espera.
+void espera_sinalizar(espera_t* espera) {
+    fibra_t* f = espera->fibra;
+    if (f == NULL) {
+        pthread_cond_signal(&espera->cond);
+        return;
+    }
+
+    espera->fibra = NULL;
+    unsigned long estado = atomic_load(&f->estado);
+    if ((estado & 1UL) && acordar(f, estado, false)) {
+        pthread_mutex_lock(&mutex_escalonador);
+        enfileirar_pronta(f);
+        pthread_mutex_unlock(&mutex_escalonador);
+    }
+}
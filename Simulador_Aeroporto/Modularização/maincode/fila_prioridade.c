@@ -1,144 +1,547 @@
 #include "aeroporto.h"
+#include <limits.h>
 
-void inicializar_fila(fila_prioridade_t* fila) {
-    fila->head = NULL;
-    fila->total_requisicoes = 0;
-    pthread_mutex_init(&fila->mutex, NULL);
+// Quatro implementacoes atras da mesma interface, escolhidas por --fila:
+// - lista: a lista ordenada original, insercao e remocao O(n);
+// - heap: heap binario indexado (cada no sabe sua posicao), insercao,
+//   remocao e mudanca de prioridade O(log n) e cabeca O(1);
+// - baldes: um FIFO por prioridade base (0..NUM_BALDES-1), em um banco para
+//   quem tem e outro para quem nao tem o bonus linear, e um mapa de bits dos
+//   niveis ocupados; insercao e remocao O(1), cabeca proporcional aos niveis
+//   ocupados, porque o envelhecimento pode levar qualquer um deles a frente;
+// - skiplist: skiplist sem travas (skiplist.c), O(log n) esperado. Inserir,
+//   remover e retirar o cabeca dispensam fila->mutex; quem ainda o trava
+//   (recursos, bonus, prazos) o faz para proteger o proprio estado.
+// A ordem e prioridade decrescente e, no empate, ordem de chegada.
+//
+// Envelhecimento em degraus (padrao, --envelhecimento=degraus): a curva
+// original. A cada segundo inteiro do relogio, ate as chegadas terminarem,
+// quem espera ha w segundos completos ganha PONTOS_POR_DEGRAU *
+// (w / DEGRAU_ENVELHECIMENTO) depois de config.carencia segundos e mais
+// config.bonus_espera depois de config.limiar_bonus. A curva e a mesma para
+// todas as classes, entao com a mesma base quem chegou antes nunca fica
+// atras; entre bases diferentes a ordem muda com o tempo, mas so na virada
+// de cada segundo. Lista e heap guardam na chave a prioridade do segundo
+// corrente e se reordenam no primeiro acesso de cada segundo
+// (fila_atualizar): a lista intercala suas sequencias por base e o heap se
+// refaz, ambos em O(n); os baldes comparam os cabecas dos niveis na hora,
+// sem passada nenhuma. A skiplist nao pode ser reordenada sem travas e exige
+// o envelhecimento linear.
+//
+// Envelhecimento linear (--envelhecimento=X): a prioridade efetiva cresce
+//     efetiva(agora) = base + taxa * (agora - chegada) [+ bonus],
+// entao a diferenca entre dois nos com a mesma taxa nunca muda com o tempo.
+// Cada no guarda a chave base - taxa * chegada, fixa enquanto ele espera, e
+// nenhuma reordenacao e necessaria. O bonus de espera longa e aplicado uma
+// unica vez, por quem acompanha a espera, via fila_aplicar_bonus.
+// Heap, lista e skiplist comparam so chaves e sao exatos quando todas as classes usam a
+// mesma taxa. Os baldes comparam os cabecas de cada nivel pela prioridade
+// efetiva no instante da consulta, entao taxas por classe saem exatas:
+// ler_opcoes recusa classes que dividiriam um nivel com taxas diferentes.
+
+#define DEGRAU_ENVELHECIMENTO 5     // segundos de espera por degrau
+#define PONTOS_POR_DEGRAU 2
+
+// Ultimo segundo em que a curva em degraus avanca: como a antiga thread de
+// envelhecimento, ela para quando as chegadas terminam.
+static _Atomic long ultimo_degrau = LONG_MAX;
+
+void fila_encerrar_envelhecimento() {
+    atomic_store(&ultimo_degrau, (long)relogio_agora());
 }
 
-void destruir_fila(fila_prioridade_t* fila) {
-    pthread_mutex_lock(&fila->mutex);
-    request_node_t* atual = fila->head;
-    while (atual != NULL) {
-        request_node_t* proximo = atual->next;
-        pthread_cond_destroy(&atual->cond_var);
-        free(atual);
-        atual = proximo;
+static long segundo_dos_degraus(double agora) {
+    long segundo = (long)agora, ultimo = atomic_load(&ultimo_degrau);
+    return segundo < ultimo ? segundo : ultimo;
+}
+
+// ------------------------------ HEAP ------------------------------
+static bool antes(const request_node_t* a, const request_node_t* b) {
+    if (a->chave != b->chave) return a->chave > b->chave;
+    return a->ordem < b->ordem;
+}
+
+static void heap_colocar(fila_prioridade_t* fila, int i, request_node_t* no) {
+    fila->heap[i] = no;
+    no->indice = i;
+}
+
+static void heap_subir(fila_prioridade_t* fila, int i) {
+    request_node_t* no = fila->heap[i];
+    while (i > 0) {
+        int pai = (i - 1) / 2;
+        if (!antes(no, fila->heap[pai])) break;
+        heap_colocar(fila, i, fila->heap[pai]);
+        i = pai;
     }
-    pthread_mutex_unlock(&fila->mutex);
-    pthread_mutex_destroy(&fila->mutex);
+    heap_colocar(fila, i, no);
 }
 
-int adicionar_requisicao(fila_prioridade_t* fila, aviao_t* aviao, tipo_recurso recurso) {
-    request_node_t* novo = malloc(sizeof(request_node_t));
-    if (novo == NULL) return -1;
-    
-    novo->aviao = aviao;
-    novo->recurso_desejado = recurso;
-    novo->tempo_chegada = time(NULL);
-    novo->atendido = false;
-    novo->next = NULL;
-    pthread_cond_init(&novo->cond_var, NULL);
-    
-    if (aviao->recursos_realocados && aviao->tipo == DOMESTICO) {
-        novo->prioridade_atual = 50;
-    } else if (aviao->tipo == DOMESTICO) {
-        novo->prioridade_atual = PRIORIDADE_BASE_DOMESTICO;
-    } else {
-        novo->prioridade_atual = PRIORIDADE_BASE_INTERNACIONAL;
+static void heap_descer(fila_prioridade_t* fila, int i) {
+    int n = fila->total_requisicoes;
+    request_node_t* no = fila->heap[i];
+    while (1) {
+        int filho = 2 * i + 1;
+        if (filho >= n) break;
+        if (filho + 1 < n && antes(fila->heap[filho + 1], fila->heap[filho])) filho++;
+        if (!antes(fila->heap[filho], no)) break;
+        heap_colocar(fila, i, fila->heap[filho]);
+        i = filho;
     }
-    
-    pthread_mutex_lock(&fila->mutex);
-    
-    if (fila->head == NULL || fila->head->prioridade_atual < novo->prioridade_atual) {
+    heap_colocar(fila, i, no);
+}
+
+static int heap_inserir(fila_prioridade_t* fila, request_node_t* no) {
+    if (fila->total_requisicoes == fila->capacidade) {
+        int nova = fila->capacidade ? fila->capacidade * 2 : 256;
+        request_node_t** heap = realloc(fila->heap, nova * sizeof(request_node_t*));
+        if (heap == NULL) return -1;
+        fila->heap = heap;
+        fila->capacidade = nova;
+        alocacoes_heap++;
+    }
+    heap_colocar(fila, fila->total_requisicoes, no);
+    fila->total_requisicoes++;
+    heap_subir(fila, no->indice);
+    return 0;
+}
+
+static void heap_remover(fila_prioridade_t* fila, request_node_t* no) {
+    int i = no->indice;
+    request_node_t* ultimo = fila->heap[--fila->total_requisicoes];
+    if (ultimo != no) {
+        heap_colocar(fila, i, ultimo);
+        heap_subir(fila, i);
+        heap_descer(fila, ultimo->indice);
+    }
+}
+
+// ------------------------------ LISTA ------------------------------
+static void lista_inserir(fila_prioridade_t* fila, request_node_t* novo) {
+    if (fila->head == NULL || antes(novo, fila->head)) {
         novo->next = fila->head;
         fila->head = novo;
     } else {
         request_node_t* atual = fila->head;
-        while (atual->next != NULL && atual->next->prioridade_atual >= novo->prioridade_atual) {
+        while (atual->next != NULL && !antes(novo, atual->next)) {
             atual = atual->next;
         }
         novo->next = atual->next;
         atual->next = novo;
     }
-    
     fila->total_requisicoes++;
-    pthread_mutex_unlock(&fila->mutex);
-    
-    return 0;
 }
 
-void remover_requisicao(fila_prioridade_t* fila, aviao_t* aviao) {
+// Reordena depois que as chaves mudaram. Com a mesma base a ordem entre dois
+// nos nunca muda, entao a lista se separa em uma sequencia ja ordenada por
+// base e as sequencias sao intercaladas pelos cabecas: O(n) por base ocupada,
+// sem ordenar nada.
+static void lista_reordenar(fila_prioridade_t* fila) {
+    request_node_t* inicio[NUM_BALDES];
+    request_node_t* fim[NUM_BALDES];
+    unsigned long long ocupadas = 0;
+    for (request_node_t* no = fila->head; no != NULL; no = no->next) {
+        int b = no->prioridade_base;
+        if (ocupadas & (1ULL << b)) fim[b]->next = no;
+        else inicio[b] = no;
+        fim[b] = no;
+        ocupadas |= 1ULL << b;
+    }
+    for (unsigned long long resto = ocupadas; resto != 0; resto &= resto - 1) {
+        fim[__builtin_ctzll(resto)]->next = NULL;
+    }
+
+    request_node_t** ligacao = &fila->head;
+    while (ocupadas != 0) {
+        // Sobrou uma sequencia: ela ja e o resto da lista.
+        if ((ocupadas & (ocupadas - 1)) == 0) {
+            *ligacao = inicio[__builtin_ctzll(ocupadas)];
+            return;
+        }
+        // A melhor sequencia cede um trecho inteiro, ate o cabeca da segunda
+        // melhor passar a frente: em regime, uma comparacao por no.
+        int melhor = -1, segunda = -1;
+        for (unsigned long long resto = ocupadas; resto != 0; resto &= resto - 1) {
+            int b = __builtin_ctzll(resto);
+            if (melhor < 0 || antes(inicio[b], inicio[melhor])) {
+                segunda = melhor;
+                melhor = b;
+            } else if (segunda < 0 || antes(inicio[b], inicio[segunda])) {
+                segunda = b;
+            }
+        }
+        request_node_t* no = inicio[melhor];
+        *ligacao = no;
+        while (no->next != NULL && !antes(inicio[segunda], no->next)) {
+            no = no->next;
+        }
+        inicio[melhor] = no->next;
+        if (inicio[melhor] == NULL) ocupadas &= ~(1ULL << melhor);
+        ligacao = &no->next;
+    }
+}
+
+static void lista_remover(fila_prioridade_t* fila, request_node_t* alvo) {
+    request_node_t** ligacao = &fila->head;
+    while (*ligacao != NULL && *ligacao != alvo) {
+        ligacao = &(*ligacao)->next;
+    }
+    if (*ligacao == NULL) return;
+    *ligacao = alvo->next;
+    alvo->next = NULL;
+    fila->total_requisicoes--;
+}
+
+// ------------------------------ BALDES ------------------------------
+// Um nivel reune quem tem a mesma prioridade base e o mesmo bonus linear. A
+// base fixa a taxa (ler_opcoes recusa classes que dividem uma base com taxas
+// diferentes), entao dentro de um nivel a ordem de chegada e a ordem das
+// chaves; nos degraus o bonus faz parte da curva e nao muda o nivel.
+static int balde_do_no(const request_node_t* no) {
+    bool bonus = no->bonus_aplicado && config.envelhecimento == ENVELHECIMENTO_LINEAR;
+    return no->prioridade_base + (bonus ? NUM_BALDES : 0);
+}
+
+// Entra pelo fim, recuando enquanto o anterior chegou depois: so quem recebe
+// o bonus fora da ordem de chegada recua algum passo.
+static void baldes_inserir(fila_prioridade_t* fila, request_node_t* no) {
+    int b = balde_do_no(no);
+    request_node_t* anterior = fila->fim_baldes[b];
+    while (anterior != NULL && anterior->ordem > no->ordem) {
+        anterior = anterior->prev;
+    }
+    request_node_t* seguinte = anterior != NULL ? anterior->next : fila->baldes[b];
+
+    no->balde = b;
+    no->prev = anterior;
+    no->next = seguinte;
+    if (anterior != NULL) anterior->next = no;
+    else fila->baldes[b] = no;
+    if (seguinte != NULL) seguinte->prev = no;
+    else fila->fim_baldes[b] = no;
+    fila->baldes_ocupados[b / NUM_BALDES] |= 1ULL << (b % NUM_BALDES);
+    fila->total_requisicoes++;
+}
+
+static void baldes_remover(fila_prioridade_t* fila, request_node_t* no) {
+    int b = no->balde;
+    if (no->prev != NULL) no->prev->next = no->next;
+    else fila->baldes[b] = no->next;
+    if (no->next != NULL) no->next->prev = no->prev;
+    else fila->fim_baldes[b] = no->prev;
+    if (fila->baldes[b] == NULL) {
+        fila->baldes_ocupados[b / NUM_BALDES] &= ~(1ULL << (b % NUM_BALDES));
+    }
+    no->next = no->prev = NULL;
+    fila->total_requisicoes--;
+}
+
+// O envelhecimento pode ter levado o cabeca de um nivel mais baixo a frente
+// dos mais altos: compara os cabecas de todos os niveis ocupados, achados
+// pelo mapa de bits.
+static request_node_t* baldes_cabeca(fila_prioridade_t* fila) {
+    double agora = relogio_agora();
+    request_node_t* melhor = NULL;
+    double prioridade_melhor = 0;
+    for (int banco = 0; banco < 2; banco++) {
+        unsigned long long ocupados = fila->baldes_ocupados[banco];
+        while (ocupados != 0) {
+            int b = __builtin_ctzll(ocupados);
+            ocupados &= ocupados - 1;
+
+            request_node_t* candidato = fila->baldes[banco * NUM_BALDES + b];
+            double prioridade = prioridade_efetiva(candidato, agora);
+            if (melhor == NULL || prioridade > prioridade_melhor ||
+                (prioridade == prioridade_melhor && candidato->ordem < melhor->ordem)) {
+                melhor = candidato;
+                prioridade_melhor = prioridade;
+            }
+        }
+    }
+    return melhor;
+}
+
+// ----------------------------- INTERFACE -----------------------------
+void inicializar_fila(fila_prioridade_t* fila) {
+    fila->head = NULL;
+    fila->heap = NULL;
+    memset(fila->baldes, 0, sizeof(fila->baldes));
+    memset(fila->fim_baldes, 0, sizeof(fila->fim_baldes));
+    memset(fila->baldes_ocupados, 0, sizeof(fila->baldes_ocupados));
+    skiplist_iniciar(&fila->skiplist);
+    fila->capacidade = 0;
+    fila->segundo = -1;
+    fila->proxima_ordem = 0;
+    fila->tipo = config.fila;
+    fila->total_requisicoes = 0;
+    pthread_mutex_init(&fila->mutex, NULL);
+}
+
+// Os nos pertencem aos avioes; destruir a fila so a esvazia.
+void destruir_fila(fila_prioridade_t* fila) {
     pthread_mutex_lock(&fila->mutex);
-    
-    request_node_t* atual = fila->head;
-    request_node_t* anterior = NULL;
-    
-    while (atual != NULL) {
-        if (atual->aviao->ID == aviao->ID) {
-            if (anterior == NULL) {
-                fila->head = atual->next;
-            } else {
-                anterior->next = atual->next;
+    if (fila->tipo == FILA_HEAP) {
+        for (int i = 0; i < fila->total_requisicoes; i++) {
+            fila->heap[i]->na_fila = false;
+        }
+    } else if (fila->tipo == FILA_BALDES) {
+        for (int b = 0; b < 2 * NUM_BALDES; b++) {
+            while (fila->baldes[b] != NULL) {
+                request_node_t* no = fila->baldes[b];
+                baldes_remover(fila, no);
+                no->na_fila = false;
             }
-            pthread_cond_destroy(&atual->cond_var);
-            free(atual);
-            fila->total_requisicoes--;
-            break;
         }
-        anterior = atual;
-        atual = atual->next;
+    } else if (fila->tipo == FILA_SKIPLIST) {
+        request_node_t* no;
+        while ((no = skiplist_retirar_primeiro(&fila->skiplist)) != NULL) {
+            no->na_fila = false;
+        }
+    } else {
+        request_node_t* atual = fila->head;
+        while (atual != NULL) {
+            request_node_t* proximo = atual->next;
+            atual->na_fila = false;
+            atual->next = NULL;
+            atual = proximo;
+        }
     }
-    
+    free(fila->heap);
+    fila->heap = NULL;
+    fila->capacidade = 0;
+    fila->head = NULL;
+    fila->total_requisicoes = 0;
     pthread_mutex_unlock(&fila->mutex);
+    pthread_mutex_destroy(&fila->mutex);
 }
 
-void atualizar_prioridades(fila_prioridade_t* fila) {
-    pthread_mutex_lock(&fila->mutex);
-    
-    request_node_t* atual = fila->head;
-    time_t agora = time(NULL);
-    
-    while (atual != NULL) {
-        time_t tempo_espera = agora - atual->tempo_chegada;
-        
-        if (tempo_espera > 10) {
-            atual->prioridade_atual += (tempo_espera / 5) * 2;
+// Curva em degraus: na virada do segundo lista e heap recebem as prioridades
+// novas e se reordenam. Chamada com fila->mutex travado, antes de consultar
+// ou percorrer a fila; fora desse caso nao faz nada.
+void fila_atualizar(fila_prioridade_t* fila) {
+    if (config.envelhecimento != ENVELHECIMENTO_DEGRAUS) return;
+    if (fila->tipo != FILA_LISTA && fila->tipo != FILA_HEAP) return;
+    double agora = relogio_agora();
+    long segundo = segundo_dos_degraus(agora);
+    if (segundo == fila->segundo) return;
+    fila->segundo = segundo;
+
+    if (fila->tipo == FILA_HEAP) {
+        for (int i = 0; i < fila->total_requisicoes; i++) {
+            fila->heap[i]->chave = prioridade_efetiva(fila->heap[i], agora);
         }
-        
-        if (tempo_espera > ALERTA_CRITICO / 2) {
-            atual->prioridade_atual += 10;
-            log_message("[SISTEMA] Aviao [%03d] teve prioridade aumentada por tempo de espera (%lds).\n", 
-                       atual->aviao->ID, tempo_espera);
+        for (int i = fila->total_requisicoes / 2 - 1; i >= 0; i--) {
+            heap_descer(fila, i);
         }
-        
-        atual = atual->next;
-    }
-    
-    // Reordena a fila
-    if (fila->head != NULL && fila->head->next != NULL) {
-        request_node_t* sorted = NULL;
-        request_node_t* current = fila->head;
-        
-        while (current != NULL) {
-            request_node_t* next = current->next;
-            
-            if (sorted == NULL || sorted->prioridade_atual < current->prioridade_atual) {
-                current->next = sorted;
-                sorted = current;
-            } else {
-                request_node_t* temp = sorted;
-                while (temp->next != NULL && temp->next->prioridade_atual >= current->prioridade_atual) {
-                    temp = temp->next;
-                }
-                current->next = temp->next;
-                temp->next = current;
-            }
-            current = next;
+    } else {
+        for (request_node_t* no = fila->head; no != NULL; no = no->next) {
+            no->chave = prioridade_efetiva(no, agora);
         }
-        fila->head = sorted;
+        lista_reordenar(fila);
+    }
+}
+
+// Chamada com fila->mutex travado.
+request_node_t* fila_cabeca(fila_prioridade_t* fila) {
+    fila_atualizar(fila);
+    if (fila->tipo == FILA_HEAP) {
+        return fila->total_requisicoes > 0 ? fila->heap[0] : NULL;
+    }
+    if (fila->tipo == FILA_BALDES) {
+        return baldes_cabeca(fila);
+    }
+    if (fila->tipo == FILA_SKIPLIST) {
+        return skiplist_primeiro(&fila->skiplist);
+    }
+    return fila->head;
+}
+
+// Retira e devolve o cabeca. So a skiplist o faz sem travar fila->mutex.
+request_node_t* fila_retirar_cabeca(fila_prioridade_t* fila) {
+    if (fila->tipo == FILA_SKIPLIST) {
+        request_node_t* no = skiplist_retirar_primeiro(&fila->skiplist);
+        if (no != NULL) no->na_fila = false;
+        return no;
+    }
+
+    pthread_mutex_lock(&fila->mutex);
+    request_node_t* no = fila_cabeca(fila);
+    if (no != NULL) {
+        remover_no_travado(fila, no);
     }
-    
     pthread_mutex_unlock(&fila->mutex);
+    return no;
 }
 
-void* thread_aging_func(void* arg) {
-    (void)arg;
-    while (sistema_ativo) {
-        atualizar_prioridades(&fila_pistas);
-        atualizar_prioridades(&fila_portoes);
-        atualizar_prioridades(&fila_torre_ops);
-        sleep(1);
+// Cada fila atende um recurso; o no do aviao nela e o desse recurso.
+static request_node_t* requisicao_do_aviao(fila_prioridade_t* fila, aviao_t* aviao) {
+    for (int r = 0; r < 3; r++) {
+        if (fila_do_recurso((tipo_recurso)r) == fila) return &aviao->requisicoes[r];
     }
     return NULL;
-}
\ No newline at end of file
+}
+
+// Versao para quem ja tem fila->mutex travado.
+int adicionar_requisicao_travada(fila_prioridade_t* fila, aviao_t* aviao, tipo_recurso recurso) {
+    return adicionar_no_travado(fila, &aviao->requisicoes[recurso]);
+}
+
+// Enfileira um no do aviao: o do recurso da fila ou o pedido de conjunto.
+int adicionar_no_travado(fila_prioridade_t* fila, request_node_t* novo) {
+    aviao_t* aviao = novo->aviao;
+    if (novo->na_fila) return -1;
+
+    novo->tempo_chegada = relogio_agora();
+    novo->atendido = false;
+    novo->preemptado = false;
+    novo->prazos_disparados = 0;
+    novo->bonus_aplicado = false;
+    novo->next = NULL;
+
+    novo->prioridade_base = prioridade_base_do_aviao(aviao);
+    if (config.envelhecimento == ENVELHECIMENTO_DEGRAUS) {
+        // Quem chega agora ainda nao ganhou nenhum degrau.
+        fila_atualizar(fila);
+        novo->taxa = 0;
+        novo->chave = novo->prioridade_base;
+    } else {
+        novo->taxa = taxa_da_classe(aviao->tipo);
+        novo->chave = novo->prioridade_base - novo->taxa * novo->tempo_chegada;
+    }
+
+    // Na skiplist o no pode ser retirado assim que entra.
+    novo->na_fila = true;
+    novo->ordem = fila->proxima_ordem++;
+    if (fila->tipo == FILA_HEAP) {
+        if (heap_inserir(fila, novo) == -1) {
+            novo->na_fila = false;
+            return -1;
+        }
+    } else if (fila->tipo == FILA_BALDES) {
+        baldes_inserir(fila, novo);
+    } else if (fila->tipo == FILA_SKIPLIST) {
+        skiplist_inserir(&fila->skiplist, novo->chave, novo->ordem, novo, &novo->torre);
+    } else {
+        lista_inserir(fila, novo);
+    }
+    requisicoes_feitas++;
+    return 0;
+}
+
+int adicionar_requisicao(fila_prioridade_t* fila, aviao_t* aviao, tipo_recurso recurso) {
+    if (fila->tipo == FILA_SKIPLIST) {
+        return adicionar_requisicao_travada(fila, aviao, recurso);
+    }
+    pthread_mutex_lock(&fila->mutex);
+    int resultado = adicionar_requisicao_travada(fila, aviao, recurso);
+    pthread_mutex_unlock(&fila->mutex);
+    return resultado;
+}
+
+// Versao para quem ja tem fila->mutex travado.
+bool remover_requisicao_travada(fila_prioridade_t* fila, aviao_t* aviao) {
+    request_node_t* alvo = requisicao_do_aviao(fila, aviao);
+    return alvo != NULL && remover_no_travado(fila, alvo);
+}
+
+bool remover_no_travado(fila_prioridade_t* fila, request_node_t* alvo) {
+    if (!alvo->na_fila) return false;
+
+    if (fila->tipo == FILA_HEAP) {
+        heap_remover(fila, alvo);
+    } else if (fila->tipo == FILA_BALDES) {
+        baldes_remover(fila, alvo);
+    } else if (fila->tipo == FILA_SKIPLIST) {
+        // Perdeu para quem retirou o cabeca ao mesmo tempo.
+        if (!skiplist_remover(&fila->skiplist, alvo->torre)) return false;
+    } else {
+        lista_remover(fila, alvo);
+    }
+    alvo->na_fila = false;
+    return true;
+}
+
+void remover_requisicao(fila_prioridade_t* fila, aviao_t* aviao) {
+    if (fila->tipo == FILA_SKIPLIST) {
+        remover_requisicao_travada(fila, aviao);
+        return;
+    }
+    pthread_mutex_lock(&fila->mutex);
+    remover_requisicao_travada(fila, aviao);
+    pthread_mutex_unlock(&fila->mutex);
+}
+
+// Soma de w / DEGRAU_ENVELHECIMENTO para w de 0 a m.
+static double soma_degraus(long m) {
+    long q = m / DEGRAU_ENVELHECIMENTO, r = m % DEGRAU_ENVELHECIMENTO;
+    return DEGRAU_ENVELHECIMENTO * q * (q - 1) / 2.0 + q * (r + 1);
+}
+
+// Pontos da curva em degraus acumulados nos segundos inteiros entre a
+// chegada e "agora": no k-esimo a espera completa e k - 1 segundos, ou k se
+// a chegada caiu exatamente na virada.
+static double pontos_degraus(double chegada, double agora) {
+    long ultima = segundo_dos_degraus(agora) - (long)chegada - (chegada != (long)chegada);
+    double pontos = 0;
+    if (ultima > config.carencia) {
+        pontos += PONTOS_POR_DEGRAU * (soma_degraus(ultima) - soma_degraus(config.carencia));
+    }
+    if (ultima > config.limiar_bonus) {
+        pontos += (double)config.bonus_espera * (ultima - config.limiar_bonus);
+    }
+    return pontos;
+}
+
+double prioridade_efetiva(const request_node_t* no, double agora) {
+    if (config.envelhecimento == ENVELHECIMENTO_DEGRAUS) {
+        return no->prioridade_base + pontos_degraus(no->tempo_chegada, agora);
+    }
+    return no->chave + no->taxa * agora;
+}
+
+// Muda a chave de um no que esta na fila. Chamada com fila->mutex travado.
+void fila_reprioritizar(fila_prioridade_t* fila, request_node_t* no, double chave) {
+    double anterior = no->chave;
+    no->chave = chave;
+    if (fila->tipo == FILA_HEAP) {
+        if (chave > anterior) heap_subir(fila, no->indice);
+        else if (chave < anterior) heap_descer(fila, no->indice);
+    } else if (fila->tipo == FILA_BALDES) {
+        // O nivel so depende da base e do bonus; chave e nivel mudam juntos.
+        baldes_remover(fila, no);
+        baldes_inserir(fila, no);
+    } else if (fila->tipo == FILA_SKIPLIST) {
+        if (skiplist_remover(&fila->skiplist, no->torre)) {
+            skiplist_inserir(&fila->skiplist, chave, no->ordem, no, &no->torre);
+        }
+    } else if (chave != anterior) {
+        lista_remover(fila, no);
+        lista_inserir(fila, no);
+    }
+}
+
+// Bonus unico para quem passou de config.limiar_bonus esperando pelo recurso.
+// Nao faz nada se o aviao ja saiu da fila ou ja recebeu o bonus. Na curva em
+// degraus o bonus ja entra a cada segundo; aqui so fica registrado.
+void fila_aplicar_bonus(fila_prioridade_t* fila, aviao_t* aviao, tipo_recurso recurso) {
+    fila_aplicar_bonus_no(fila, &aviao->requisicoes[recurso]);
+}
+
+// Retorna true se o bonus foi aplicado agora.
+bool fila_aplicar_bonus_no(fila_prioridade_t* fila, request_node_t* no) {
+    pthread_mutex_lock(&fila->mutex);
+    bool aplicar = no->na_fila && !no->bonus_aplicado;
+    if (aplicar) {
+        no->bonus_aplicado = true;
+        if (config.envelhecimento == ENVELHECIMENTO_LINEAR) {
+            fila_reprioritizar(fila, no, no->chave + config.bonus_espera);
+        }
+    }
+    pthread_mutex_unlock(&fila->mutex);
+
+    if (aplicar) {
+        log_evento(LOG_SISTEMA, NIVEL_DETALHE, "[SISTEMA] Aviao [%03d] teve prioridade aumentada por tempo de espera (%lds).\n",
+                   no->aviao->ID, (long)(relogio_agora() - no->tempo_chegada));
+    }
+    return aplicar;
+}
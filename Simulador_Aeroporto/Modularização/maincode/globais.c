@@ -12,21 +12,52 @@ int NUM_TORRES;
 int NUM_OP_TORRES;
 
 // ------------- VARIÁVEIS GLOBAIS -------------
+// Campos omitidos comecam em zero; semente e trabalhadores saem de ler_opcoes.
+configuracao_t config = {
+    .motor               = MOTOR_THREADS,
+    .escala_tempo        = 1.0,
+    .pilha_fibra         = 64 * 1024,
+    .fator_chegadas      = 1.0,
+    .fila                = FILA_HEAP,
+    .envelhecimento      = ENVELHECIMENTO_DEGRAUS,
+    .taxa_envelhecimento = 0.4,
+    .carencia            = 10,
+    .bonus_espera        = 10,
+    .limiar_bonus        = -1,
+    .aquisicao           = AQUISICAO_PADRAO,
+    .ordem_global        = { RECURSO_TORRE, RECURSO_PORTAO, RECURSO_PISTA },
+    .log_capacidade      = CAPACIDADE_LOG_PADRAO,
+    .log_cheio           = LOG_CHEIO_BLOQUEAR,
+    .log_saidas          = -1,
+};
+classe_voo_t classes_voo[NUM_CLASSES_VOO] = {
+    [DOMESTICO]     = { "Domestico",     PRIORIDADE_BASE_DOMESTICO,     -1, 1, DOMESTICO },
+    [INTERNACIONAL] = { "Internacional", PRIORIDADE_BASE_INTERNACIONAL, -1, 1, INTERNACIONAL },
+    [EMERGENCIA]    = { "Emergencia",    PRIORIDADE_BASE_EMERGENCIA,    -1, 0, INTERNACIONAL },
+    [MEDICO]        = { "Medico",        PRIORIDADE_BASE_MEDICO,        -1, 0, INTERNACIONAL },
+    [CARGA]         = { "Carga",         PRIORIDADE_BASE_CARGA,         -1, 0, DOMESTICO },
+    [AVIACAO_GERAL] = { "Aviacao geral", PRIORIDADE_BASE_AVIACAO_GERAL, -1, 0, DOMESTICO },
+};
 detector_deadlock_t detector;
 int contador_deadlocks = 0;
 int contador_starvation = 0;
 int recursos_realocados = 0;
 pthread_mutex_t mutex_contadores;
-aviao_t* avioes_com_warnings[MAX_AVIOES];
+aviao_t** avioes_com_warnings = NULL;
 int num_avioes_warnings = 0;
+int capacidade_avioes_warnings = 0;
 pthread_mutex_t mutex_warnings;
 bool sistema_ativo = true;
 pthread_mutex_t mutex_lista_avioes;
+_Atomic unsigned long alocacoes_heap = 0;
+_Atomic unsigned long requisicoes_feitas = 0;
 
-// -------------- SEMÁFOROS --------------
-sem_t sem_pistas;
-sem_t sem_portoes;
-sem_t sem_torre_ops;
+// -------------- RECURSOS --------------
+recurso_t recurso_pistas;
+recurso_t recurso_portoes;
+recurso_t recurso_torre_ops;
+alocador_conjuntos_t conjuntos;
+banqueiro_t banqueiro;
 
 // -------------- FILAS DE PRIORIDADE --------------
 fila_prioridade_t fila_pistas;
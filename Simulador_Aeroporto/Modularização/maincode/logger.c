@@ -1,54 +1,968 @@
 #include "logger.h"
+#include "relogio.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdbool.h>
 #include <time.h>
 #include <stdarg.h>
 #include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 
-static FILE* log_file = NULL;
-static pthread_mutex_t log_mutex;
+// ------------------------- LOG ASSINCRONO -------------------------
+// Anel limitado de varios produtores (fila de Vyukov): cada posicao tem uma
+// sequencia que diz se esta livre para a volta atual da cauda ou pronta para
+// a leitura. Quem registra reserva uma posicao com um CAS na cauda, copia o
+// numero do formato, a data e os argumentos crus e a publica; quem pode estar
+// segurando o mutex de uma fila ou do detector nao espera por disco,
+// formatacao, localtime nem fflush. A thread escritora retira lotes de
+// LOTE_LOG registros e os entrega as saidas.
+//
+// Com LOG_CHEIO_SOBRESCREVER o produtor tambem retira da cabeca, descartando
+// a mensagem mais antiga, entao a cabeca e disputada com CAS como a cauda.
 
-void log_init(const char* filename) {
-    log_file = fopen(filename, "w");
-    if (log_file == NULL) {
-        perror("Falha ao abrir o arquivo de log");
+#define LOTE_LOG            64
+#define ESPERA_ESCRITORA    0.01    // segundos reais entre varreduras ociosas
+#define TAMANHO_TEXTO_LOG   1024    // mensagem formatada pela escritora
+
+typedef struct {
+    atomic_size_t sequencia;
+    uint16_t formato;
+    uint16_t tamanho;
+    uint8_t categoria;          // NUM_CATEGORIAS_LOG em log_message
+    uint8_t nivel;
+    time_t data;
+    unsigned char argumentos[TAMANHO_REGISTRO_LOG];
+} registro_log_t;
+
+static registro_log_t* anel = NULL;
+static size_t capacidade_anel;
+static politica_log_cheio politica_cheio;
+
+static _Alignas(64) atomic_size_t cauda;    // proxima posicao a reservar
+static _Alignas(64) atomic_size_t cabeca;   // proxima posicao a retirar
+
+static pthread_t thread_escritora;
+static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_dados;           // acorda a escritora
+static pthread_cond_t cond_espaco;          // acorda quem espera espaco ou esvaziamento
+static bool escritora_ativa = false;
+static atomic_bool escritora_dormindo;
+static atomic_int aguardando_escritora;     // produtores bloqueados e log_esvaziar
+static size_t escritos = 0;                 // posicoes abaixo disso ja estao nos arquivos (log_mutex)
+
+static atomic_ulong mensagens, descartadas, sobrescritas, truncadas, esperas;
+static unsigned long lotes = 0;
+
+// ------------------------- CATEGORIAS -------------------------
+// O nivel de cada categoria e lido sem trava por log_evento; limite e
+// amostra so sao mudados pelas opcoes, antes de qualquer mensagem. A janela
+// do limite e o segundo simulado: quem ve o segundo mudar zera a contagem.
+
+nivel_log log_niveis[NUM_CATEGORIAS_LOG] = {
+    NIVEL_DETALHE, NIVEL_DETALHE, NIVEL_DETALHE, NIVEL_DETALHE, NIVEL_DETALHE
+};
+
+static const char* NOMES_CATEGORIAS[NUM_CATEGORIAS_LOG] = { "sistema", "aviao", "recurso", "alerta", "deadlock" };
+static const char* NOMES_NIVEIS[] = { "erro", "aviso", "info", "detalhe" };
+static const char* NOMES_SAIDAS[] = { "arquivo", "console", "memoria", "json" };
+
+typedef struct {
+    int limite;                 // mensagens por segundo simulado, 0 = sem limite
+    int amostra;                // registra 1 de cada "amostra", 0 ou 1 = todas
+    atomic_long janela;         // segundo simulado da contagem atual
+    atomic_int na_janela;
+    atomic_ulong vistas;        // para a amostra
+    atomic_ulong registradas, limitadas, fora_da_amostra;
+} controle_categoria_t;
+
+static controle_categoria_t controles[NUM_CATEGORIAS_LOG];
+
+static int indice_por_nome(const char** nomes, int total, const char* nome, size_t tamanho) {
+    for (int i = 0; i < total; i++) {
+        if (strlen(nomes[i]) == tamanho && strncmp(nome, nomes[i], tamanho) == 0) return i;
+    }
+    return -1;
+}
+
+// "nivel" para todas as categorias ou "categoria:nivel".
+int log_definir_nivel(const char* especificacao) {
+    const char* separador = strchr(especificacao, ':');
+    int categoria = -1;
+    if (separador != NULL) {
+        categoria = indice_por_nome(NOMES_CATEGORIAS, NUM_CATEGORIAS_LOG, especificacao,
+                                    separador - especificacao);
+        if (categoria < 0) return -1;
+        especificacao = separador + 1;
+    }
+    int nivel = indice_por_nome(NOMES_NIVEIS, NIVEL_DETALHE + 1, especificacao, strlen(especificacao));
+    if (nivel < 0) return -1;
+
+    for (int c = 0; c < NUM_CATEGORIAS_LOG; c++) {
+        if (categoria < 0 || c == categoria) log_niveis[c] = (nivel_log)nivel;
+    }
+    return 0;
+}
+
+// "categoria:N": no maximo N mensagens por segundo simulado, ou uma de cada N.
+int log_definir_limite(const char* especificacao, bool amostra) {
+    const char* separador = strchr(especificacao, ':');
+    if (separador == NULL) return -1;
+    int categoria = indice_por_nome(NOMES_CATEGORIAS, NUM_CATEGORIAS_LOG, especificacao,
+                                    separador - especificacao);
+    char* fim;
+    long valor = strtol(separador + 1, &fim, 10);
+    if (categoria < 0 || *fim != '\0' || valor < 1 || valor > INT32_MAX) return -1;
+
+    if (amostra) {
+        controles[categoria].amostra = (int)valor;
+    } else {
+        controles[categoria].limite = (int)valor;
+    }
+    return 0;
+}
+
+// Lista separada por virgulas de arquivo, console, memoria e json, ou "nulo"
+// para nenhuma. Devolve a combinacao de SAIDA_LOG_* ou -1.
+int log_ler_saidas(const char* especificacao) {
+    int saidas = 0;
+    const char* campo = especificacao;
+    for (;;) {
+        size_t tamanho = strcspn(campo, ",");
+        int saida = indice_por_nome(NOMES_SAIDAS, 4, campo, tamanho);
+        if (saida >= 0) {
+            saidas |= 1 << saida;
+        } else if (tamanho != 4 || strncmp(campo, "nulo", 4) != 0) {
+            return -1;
+        }
+        campo += tamanho;
+        if (*campo == '\0') return saidas;
+        campo++;
+    }
+}
+
+// Decide se a mensagem de uma categoria com limite ou amostra passa.
+static bool dentro_do_limite(controle_categoria_t* c, time_t data) {
+    if (c->amostra > 1 && atomic_fetch_add_explicit(&c->vistas, 1, memory_order_relaxed) % c->amostra != 0) {
+        atomic_fetch_add_explicit(&c->fora_da_amostra, 1, memory_order_relaxed);
+        return false;
+    }
+    if (c->limite > 0) {
+        long janela = atomic_load_explicit(&c->janela, memory_order_relaxed);
+        if (janela != (long)data &&
+            atomic_compare_exchange_strong_explicit(&c->janela, &janela, (long)data, memory_order_relaxed,
+                                                    memory_order_relaxed)) {
+            atomic_store_explicit(&c->na_janela, 0, memory_order_relaxed);
+        }
+        if (atomic_fetch_add_explicit(&c->na_janela, 1, memory_order_relaxed) >= c->limite) {
+            atomic_fetch_add_explicit(&c->limitadas, 1, memory_order_relaxed);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ------------------------- FORMATOS -------------------------
+// Cada string de formato e registrada no primeiro uso e ganha um numero. A
+// tabela de espalhamento e indexada pelo ponteiro da string: a busca nao
+// trava nada e so o registro de um formato novo passa pelo mutex. A chave e
+// publicada por ultimo, depois do formato analisado.
+
+#define POSICOES_FORMATOS   (2 * MAX_FORMATOS_LOG)
+
+typedef struct {
+    const char* formato;
+    int num_argumentos;
+    tipo_argumento_log tipos[MAX_ARGUMENTOS_LOG];
+    int reservados[MAX_ARGUMENTOS_LOG];     // bytes minimos dos argumentos seguintes
+} formato_log_t;
+
+static _Atomic(const char*) chaves_formatos[POSICOES_FORMATOS];
+static int ids_formatos[POSICOES_FORMATOS];
+static formato_log_t formatos[MAX_FORMATOS_LOG];
+static int num_formatos = 0;
+static int formatos_gravados = 0;           // so a escritora, no modo binario
+static pthread_mutex_t mutex_formatos = PTHREAD_MUTEX_INITIALIZER;
+
+static const int BYTES_ARGUMENTO[] = {
+    [ARG_LOG_INT] = 4, [ARG_LOG_LONG] = 8, [ARG_LOG_DOUBLE] = 8, [ARG_LOG_TEXTO] = 1, [ARG_LOG_PONTEIRO] = 8
+};
+
+// Le a conversao que comeca no '%' de p. Devolve o tamanho da especificacao
+// e o tipo do argumento, ou -1 se ela nao e suportada (largura '*', "ll",
+// long double, %n).
+static int ler_conversao(const char* p, tipo_argumento_log* tipo) {
+    const char* q = p + 1;
+    while (*q != '\0' && strchr("-+ #0", *q) != NULL) q++;
+    while (isdigit((unsigned char)*q)) q++;
+    if (*q == '.') {
+        q++;
+        while (isdigit((unsigned char)*q)) q++;
+    }
+    bool longo = false;
+    if (*q == 'h') {
+        q++;
+        if (*q == 'h') q++;
+    } else if (*q == 'l' || *q == 'z' || *q == 't') {
+        longo = true;
+        q++;
+    }
+
+    switch (*q) {
+        case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+            *tipo = longo ? ARG_LOG_LONG : ARG_LOG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            *tipo = ARG_LOG_DOUBLE;
+            break;
+        case 's':
+            *tipo = ARG_LOG_TEXTO;
+            break;
+        case 'p':
+            *tipo = ARG_LOG_PONTEIRO;
+            break;
+        default:
+            return -1;
+    }
+    return (int)(q - p) + 1;
+}
+
+// Preenche os tipos dos argumentos de um formato. Devolve quantos sao ou -1.
+int log_analisar_formato(const char* formato, tipo_argumento_log* tipos) {
+    int num_argumentos = 0;
+    for (const char* p = formato; *p != '\0'; p++) {
+        if (*p != '%') continue;
+        if (p[1] == '%') {
+            p++;
+            continue;
+        }
+        tipo_argumento_log tipo;
+        int tamanho = ler_conversao(p, &tipo);
+        if (tamanho < 0 || num_argumentos == MAX_ARGUMENTOS_LOG) return -1;
+        tipos[num_argumentos++] = tipo;
+        p += tamanho - 1;
+    }
+    return num_argumentos;
+}
+
+// Formata uma mensagem a partir dos argumentos copiados por log_message.
+// Argumentos que faltam (registro truncado) saem como zero ou vazio.
+size_t log_formatar(const char* formato, const unsigned char* argumentos, size_t tamanho, char* saida,
+                    size_t capacidade) {
+    size_t usado = 0, lido = 0;
+    const char* p = formato;
+    while (*p != '\0' && usado + 1 < capacidade) {
+        if (*p != '%') {
+            saida[usado++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            saida[usado++] = '%';
+            p += 2;
+            continue;
+        }
+
+        tipo_argumento_log tipo;
+        char especificacao[32];
+        int n = ler_conversao(p, &tipo);
+        if (n < 0 || n >= (int)sizeof(especificacao)) break;
+        memcpy(especificacao, p, n);
+        especificacao[n] = '\0';
+        p += n;
+
+        size_t resto = capacidade - usado;
+        int escrito = 0;
+        if (tipo == ARG_LOG_TEXTO) {
+            const char* texto = "";
+            if (lido < tamanho && strnlen((const char*)argumentos + lido, tamanho - lido) < tamanho - lido) {
+                texto = (const char*)argumentos + lido;
+                lido += strlen(texto) + 1;
+            } else {
+                lido = tamanho;
+            }
+            escrito = snprintf(saida + usado, resto, especificacao, texto);
+        } else if (tipo == ARG_LOG_INT) {
+            int valor = 0;
+            if (lido + 4 <= tamanho) memcpy(&valor, argumentos + lido, 4);
+            lido += 4;
+            escrito = snprintf(saida + usado, resto, especificacao, valor);
+        } else if (tipo == ARG_LOG_LONG) {
+            long valor = 0;
+            if (lido + 8 <= tamanho) memcpy(&valor, argumentos + lido, 8);
+            lido += 8;
+            escrito = snprintf(saida + usado, resto, especificacao, valor);
+        } else if (tipo == ARG_LOG_DOUBLE) {
+            double valor = 0.0;
+            if (lido + 8 <= tamanho) memcpy(&valor, argumentos + lido, 8);
+            lido += 8;
+            escrito = snprintf(saida + usado, resto, especificacao, valor);
+        } else {
+            void* valor = NULL;
+            if (lido + 8 <= tamanho) memcpy(&valor, argumentos + lido, 8);
+            lido += 8;
+            escrito = snprintf(saida + usado, resto, especificacao, valor);
+        }
+        if (escrito < 0) break;
+        usado += (size_t)escrito < resto ? (size_t)escrito : resto - 1;
+    }
+    saida[usado] = '\0';
+    return usado;
+}
+
+static size_t posicao_do_formato(const char* formato) {
+    return (size_t)(((uint64_t)(uintptr_t)formato * 0x9E3779B97F4A7C15ULL) >> 40) & (POSICOES_FORMATOS - 1);
+}
+
+static int registrar_formato(const char* formato) {
+    pthread_mutex_lock(&mutex_formatos);
+    size_t i = posicao_do_formato(formato);
+    const char* chave;
+    while ((chave = atomic_load_explicit(&chaves_formatos[i], memory_order_relaxed)) != NULL) {
+        if (chave == formato) {
+            pthread_mutex_unlock(&mutex_formatos);
+            return ids_formatos[i];
+        }
+        i = (i + 1) & (POSICOES_FORMATOS - 1);
+    }
+
+    if (num_formatos == MAX_FORMATOS_LOG) {
+        fprintf(stderr, "Mais de %d formatos de log.\n", MAX_FORMATOS_LOG);
+        exit(EXIT_FAILURE);
+    }
+    formato_log_t* f = &formatos[num_formatos];
+    f->formato = formato;
+    f->num_argumentos = log_analisar_formato(formato, f->tipos);
+    if (f->num_argumentos < 0) {
+        fprintf(stderr, "Formato de log nao suportado: %s", formato);
         exit(EXIT_FAILURE);
     }
-    pthread_mutex_init(&log_mutex, NULL);
-    
-    fprintf(log_file, "--- Log da Simulação do Aeroporto ---\n");
-    fflush(log_file);
+    int reservados = 0;
+    for (int a = f->num_argumentos - 1; a >= 0; a--) {
+        f->reservados[a] = reservados;
+        reservados += BYTES_ARGUMENTO[f->tipos[a]];
+    }
+
+    int id = num_formatos++;
+    ids_formatos[i] = id;
+    atomic_store_explicit(&chaves_formatos[i], formato, memory_order_release);
+    pthread_mutex_unlock(&mutex_formatos);
+    return id;
+}
+
+static int id_do_formato(const char* formato) {
+    for (size_t i = posicao_do_formato(formato);; i = (i + 1) & (POSICOES_FORMATOS - 1)) {
+        const char* chave = atomic_load_explicit(&chaves_formatos[i], memory_order_acquire);
+        if (chave == formato) return ids_formatos[i];
+        if (chave == NULL) return registrar_formato(formato);
+    }
 }
 
-void log_message(const char* format, ...) {
+// Copia os argumentos na ordem do formato. Um texto longo e cortado para
+// sempre caber o que vem depois dele. Devolve os bytes usados.
+static uint16_t copiar_argumentos(const formato_log_t* f, unsigned char* destino, va_list args) {
+    size_t usado = 0;
+    for (int a = 0; a < f->num_argumentos; a++) {
+        switch (f->tipos[a]) {
+            case ARG_LOG_INT: {
+                int valor = va_arg(args, int);
+                memcpy(destino + usado, &valor, 4);
+                usado += 4;
+                break;
+            }
+            case ARG_LOG_LONG: {
+                long valor = va_arg(args, long);
+                memcpy(destino + usado, &valor, 8);
+                usado += 8;
+                break;
+            }
+            case ARG_LOG_DOUBLE: {
+                double valor = va_arg(args, double);
+                memcpy(destino + usado, &valor, 8);
+                usado += 8;
+                break;
+            }
+            case ARG_LOG_PONTEIRO: {
+                void* valor = va_arg(args, void*);
+                memcpy(destino + usado, &valor, 8);
+                usado += 8;
+                break;
+            }
+            case ARG_LOG_TEXTO: {
+                const char* texto = va_arg(args, const char*);
+                if (texto == NULL) texto = "(null)";
+                size_t cabe = TAMANHO_REGISTRO_LOG - usado - f->reservados[a] - 1;
+                size_t n = strnlen(texto, cabe + 1);
+                if (n > cabe) {
+                    n = cabe;
+                    atomic_fetch_add(&truncadas, 1);
+                }
+                memcpy(destino + usado, texto, n);
+                destino[usado + n] = '\0';
+                usado += n + 1;
+                break;
+            }
+        }
+    }
+    return (uint16_t)usado;
+}
+
+// ------------------------- ANEL -------------------------
+
+static registro_log_t* reservar(size_t* posicao) {
+    size_t pos = atomic_load_explicit(&cauda, memory_order_relaxed);
+    for (;;) {
+        registro_log_t* reg = &anel[pos & (capacidade_anel - 1)];
+        size_t seq = atomic_load_explicit(&reg->sequencia, memory_order_acquire);
+        intptr_t diferenca = (intptr_t)seq - (intptr_t)pos;
+        if (diferenca == 0) {
+            if (atomic_compare_exchange_weak_explicit(&cauda, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                *posicao = pos;
+                return reg;
+            }
+        } else if (diferenca < 0) {
+            return NULL;
+        } else {
+            pos = atomic_load_explicit(&cauda, memory_order_relaxed);
+        }
+    }
+}
+
+// Retira o registro mais antigo ja publicado, copiando-o para "destino" se
+// nao for NULL. Falso se a cabeca esta vazia ou ainda sendo escrita.
+static bool retirar(registro_log_t* destino) {
+    size_t pos = atomic_load_explicit(&cabeca, memory_order_relaxed);
+    registro_log_t* reg;
+    for (;;) {
+        reg = &anel[pos & (capacidade_anel - 1)];
+        size_t seq = atomic_load_explicit(&reg->sequencia, memory_order_acquire);
+        intptr_t diferenca = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diferenca == 0) {
+            if (atomic_compare_exchange_weak_explicit(&cabeca, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                break;
+            }
+        } else if (diferenca < 0) {
+            return false;
+        } else {
+            pos = atomic_load_explicit(&cabeca, memory_order_relaxed);
+        }
+    }
+    if (destino != NULL) {
+        destino->formato = reg->formato;
+        destino->tamanho = reg->tamanho;
+        destino->categoria = reg->categoria;
+        destino->nivel = reg->nivel;
+        destino->data = reg->data;
+        memcpy(destino->argumentos, reg->argumentos, reg->tamanho);
+    }
+    atomic_store_explicit(&reg->sequencia, pos + capacidade_anel, memory_order_release);
+    return true;
+}
+
+static bool anel_vazio() {
+    size_t pos = atomic_load(&cabeca);
+    return atomic_load(&anel[pos & (capacidade_anel - 1)].sequencia) != pos + 1;
+}
+
+// Produtor com o anel cheio e LOG_CHEIO_BLOQUEAR: dorme ate a escritora
+// retirar um lote.
+static void esperar_espaco() {
+    atomic_fetch_add(&esperas, 1);
     pthread_mutex_lock(&log_mutex);
+    atomic_fetch_add(&aguardando_escritora, 1);
+    pthread_cond_signal(&cond_dados);
+    while (escritora_ativa && atomic_load(&cauda) - atomic_load(&cabeca) >= capacidade_anel) {
+        pthread_cond_wait(&cond_espaco, &log_mutex);
+    }
+    atomic_fetch_sub(&aguardando_escritora, 1);
+    pthread_mutex_unlock(&log_mutex);
+}
 
-    time_t now = time(NULL);
-    struct tm* t = localtime(&now);
-    char time_buf[32];
-    strftime(time_buf, sizeof(time_buf) - 1, "%Y-%m-%d %H:%M:%S", t);
-    va_list args_console;
-    va_start(args_console, format);
-    vprintf(format, args_console);
-    va_end(args_console);
+static void escrever_direto(const char* format, va_list args) {
+    pthread_mutex_lock(&log_mutex);
+    vprintf(format, args);
     fflush(stdout);
-    if (log_file) {
-        fprintf(log_file, "[%s] ", time_buf);
-        
-        va_list args_file;
-        va_start(args_file, format);
-        vfprintf(log_file, format, args_file);
-        va_end(args_file);
-        fflush(log_file);
+    pthread_mutex_unlock(&log_mutex);
+}
+
+static void registrar(categoria_log categoria, nivel_log nivel, const char* format, time_t data, va_list args) {
+    if (anel == NULL) {
+        escrever_direto(format, args);
+        return;
+    }
+
+    int id = id_do_formato(format);
+    size_t pos;
+    registro_log_t* reg;
+    while ((reg = reservar(&pos)) == NULL) {
+        if (politica_cheio == LOG_CHEIO_DESCARTAR) {
+            atomic_fetch_add(&descartadas, 1);
+            return;
+        }
+        if (politica_cheio == LOG_CHEIO_SOBRESCREVER) {
+            if (retirar(NULL)) {
+                atomic_fetch_add(&sobrescritas, 1);
+            } else {
+                sched_yield();
+            }
+        } else {
+            esperar_espaco();
+        }
     }
 
+    reg->formato = (uint16_t)id;
+    reg->categoria = (uint8_t)categoria;
+    reg->nivel = (uint8_t)nivel;
+    reg->data = data;
+    reg->tamanho = copiar_argumentos(&formatos[id], reg->argumentos, args);
+    atomic_fetch_add_explicit(&mensagens, 1, memory_order_relaxed);
+
+    // A publicacao e seq_cst para ser vista antes da leitura de
+    // escritora_dormindo, que a escritora liga antes de olhar o anel.
+    atomic_store(&reg->sequencia, pos + 1);
+    if (atomic_load(&escritora_dormindo) && pos - atomic_load(&cabeca) >= capacidade_anel / 2) {
+        pthread_mutex_lock(&log_mutex);
+        pthread_cond_signal(&cond_dados);
+        pthread_mutex_unlock(&log_mutex);
+    }
+}
+
+// Mensagem sem categoria (benchmarks e o que nao passa por log_evento).
+void log_message(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    registrar(NUM_CATEGORIAS_LOG, NIVEL_INFO, format, relogio_data_grossa(), args);
+    va_end(args);
+}
+
+// Chamada por log_evento, que ja conferiu o nivel.
+void log_categoria(categoria_log categoria, nivel_log nivel, const char* format, ...) {
+    controle_categoria_t* c = &controles[categoria];
+    time_t data = relogio_data_grossa();
+    if ((c->limite > 0 || c->amostra > 1) && !dentro_do_limite(c, data)) return;
+    atomic_fetch_add_explicit(&c->registradas, 1, memory_order_relaxed);
+
+    va_list args;
+    va_start(args, format);
+    registrar(categoria, nivel, format, data, args);
+    va_end(args);
+}
+
+// ------------------------- SAIDAS -------------------------
+// So a escritora usa as saidas (e log_init e log_close, com ela parada). Cada
+// uma junta o que recebe no proprio buffer e o entrega ao FILE, com um fwrite
+// e um fflush, quando ele enche ou quando a escritora fica sem trabalho: com o
+// anel sempre cheio o console nao custa mais um fflush por lote. A memoria e
+// um buffer circular que nunca e entregue.
+
+#define TAMANHO_BUFFER_SAIDA    (64 * 1024)
+#define MAX_SAIDAS_LOG          4
+
+typedef struct saida_t saida_t;
+
+struct saida_t {
+    const char* nome;
+    FILE* arquivo;                  // NULL na memoria
+    char* buffer;
+    size_t usado;                   // ainda nao entregue ao FILE
+    unsigned long mensagens, bytes;
+    void (*escrever)(saida_t* saida, const registro_log_t* r, const char* data, const char* texto,
+                     size_t tamanho);
+};
+
+static saida_t saidas[MAX_SAIDAS_LOG];
+static int num_saidas = 0;
+static bool saidas_com_texto = false;       // alguma saida precisa da mensagem formatada
+static saida_t* saida_arquivo = NULL;
+static saida_t* saida_memoria = NULL;
+static bool arquivo_binario = false;
+
+static void descarregar(saida_t* s) {
+    if (s->arquivo == NULL || s->usado == 0) return;
+    fwrite(s->buffer, 1, s->usado, s->arquivo);
+    fflush(s->arquivo);
+    s->usado = 0;
+}
+
+static void descarregar_saidas() {
+    for (int i = 0; i < num_saidas; i++) descarregar(&saidas[i]);
+}
+
+static void acrescentar(saida_t* s, const void* dados, size_t tamanho) {
+    const char* p = dados;
+    if (s->arquivo == NULL) {
+        // Na memoria so os ultimos TAMANHO_MEMORIA_LOG bytes importam.
+        size_t pulados = tamanho > TAMANHO_MEMORIA_LOG ? tamanho - TAMANHO_MEMORIA_LOG : 0;
+        size_t pos = (s->bytes + pulados) % TAMANHO_MEMORIA_LOG;
+        size_t resto = tamanho - pulados;
+        size_t primeiro = resto < TAMANHO_MEMORIA_LOG - pos ? resto : TAMANHO_MEMORIA_LOG - pos;
+        memcpy(s->buffer + pos, p + pulados, primeiro);
+        memcpy(s->buffer, p + pulados + primeiro, resto - primeiro);
+        s->bytes += tamanho;
+        return;
+    }
+    s->bytes += tamanho;
+    if (s->usado + tamanho > TAMANHO_BUFFER_SAIDA) descarregar(s);
+    if (tamanho > TAMANHO_BUFFER_SAIDA) {
+        fwrite(p, 1, tamanho, s->arquivo);
+        return;
+    }
+    memcpy(s->buffer + s->usado, p, tamanho);
+    s->usado += tamanho;
+}
+
+static void acrescentar_datado(saida_t* s, const char* data, const char* texto, size_t tamanho) {
+    acrescentar(s, "[", 1);
+    acrescentar(s, data, strlen(data));
+    acrescentar(s, "] ", 2);
+    acrescentar(s, texto, tamanho);
+}
+
+// Arquivo de texto e memoria: "[data] mensagem", como sempre foi o log.
+static void escrever_datado(saida_t* s, const registro_log_t* r, const char* data, const char* texto,
+                            size_t tamanho) {
+    (void)r;
+    acrescentar_datado(s, data, texto, tamanho);
+    s->mensagens++;
+}
+
+static void escrever_console(saida_t* s, const registro_log_t* r, const char* data, const char* texto,
+                             size_t tamanho) {
+    (void)r;
+    (void)data;
+    acrescentar(s, texto, tamanho);
+    s->mensagens++;
+}
+
+static void gravar_binario(saida_t* s, uint8_t marca, const void* cabecalho, size_t tamanho_cabecalho,
+                           const void* dados, size_t tamanho) {
+    acrescentar(s, &marca, 1);
+    acrescentar(s, cabecalho, tamanho_cabecalho);
+    acrescentar(s, dados, tamanho);
+}
+
+// Formatos registrados ate "id" que ainda nao estao no arquivo. O registro
+// do formato aconteceu antes da publicacao da mensagem que o usa.
+static void gravar_formatos(saida_t* s, int id) {
+    for (; formatos_gravados <= id; formatos_gravados++) {
+        const char* formato = formatos[formatos_gravados].formato;
+        uint16_t cabecalho[2] = { (uint16_t)formatos_gravados, (uint16_t)strlen(formato) };
+        gravar_binario(s, LOG_BIN_FORMATO, cabecalho, sizeof(cabecalho), formato, cabecalho[1]);
+    }
+}
+
+static void escrever_binario(saida_t* s, const registro_log_t* r, const char* data, const char* texto,
+                             size_t tamanho) {
+    (void)data;
+    (void)texto;
+    (void)tamanho;
+    gravar_formatos(s, r->formato);
+    unsigned char cabecalho[4 + sizeof(int64_t)];
+    int64_t segundos = r->data;
+    memcpy(cabecalho, &r->formato, 2);
+    memcpy(cabecalho + 2, &r->tamanho, 2);
+    memcpy(cabecalho + 4, &segundos, sizeof(segundos));
+    gravar_binario(s, LOG_BIN_MENSAGEM, cabecalho, sizeof(cabecalho), r->argumentos, r->tamanho);
+    s->mensagens++;
+}
+
+// Um objeto por linha: {"data":...,"categoria":...,"nivel":...,"mensagem":...},
+// sem as quebras de linha das pontas da mensagem. Linhas em branco, que so
+// espacam o texto, ficam de fora.
+static void escrever_json(saida_t* s, const registro_log_t* r, const char* data, const char* texto,
+                          size_t tamanho) {
+    static const char HEX[] = "0123456789abcdef";
+    static char linha[6 * TAMANHO_TEXTO_LOG + 160];
+
+    while (tamanho > 0 && *texto == '\n') {
+        texto++;
+        tamanho--;
+    }
+    while (tamanho > 0 && texto[tamanho - 1] == '\n') tamanho--;
+    if (tamanho == 0) return;
+
+    int n;
+    if (r->categoria < NUM_CATEGORIAS_LOG) {
+        n = snprintf(linha, sizeof(linha), "{\"data\":\"%s\",\"categoria\":\"%s\",\"nivel\":\"%s\",\"mensagem\":\"",
+                     data, NOMES_CATEGORIAS[r->categoria], NOMES_NIVEIS[r->nivel]);
+    } else {
+        n = snprintf(linha, sizeof(linha), "{\"data\":\"%s\",\"categoria\":null,\"nivel\":null,\"mensagem\":\"",
+                     data);
+    }
+    size_t usado = (size_t)n;
+    for (size_t i = 0; i < tamanho; i++) {
+        unsigned char c = (unsigned char)texto[i];
+        if (c == '"' || c == '\\') {
+            linha[usado++] = '\\';
+            linha[usado++] = (char)c;
+        } else if (c == '\n') {
+            linha[usado++] = '\\';
+            linha[usado++] = 'n';
+        } else if (c < 0x20) {
+            memcpy(linha + usado, "\\u00", 4);
+            linha[usado + 4] = HEX[c >> 4];
+            linha[usado + 5] = HEX[c & 0xf];
+            usado += 6;
+        } else {
+            linha[usado++] = (char)c;
+        }
+    }
+    memcpy(linha + usado, "\"}\n", 3);
+    acrescentar(s, linha, usado + 3);
+    s->mensagens++;
+}
+
+static saida_t* abrir_saida(const char* nome, FILE* arquivo, size_t tamanho_buffer,
+                            void (*escrever)(saida_t*, const registro_log_t*, const char*, const char*, size_t)) {
+    saida_t* s = &saidas[num_saidas++];
+    memset(s, 0, sizeof(*s));
+    s->nome = nome;
+    s->arquivo = arquivo;
+    s->escrever = escrever;
+    s->buffer = malloc(tamanho_buffer);
+    if (s->buffer == NULL) {
+        perror("Falha ao alocar o buffer do log");
+        exit(EXIT_FAILURE);
+    }
+    if (escrever != escrever_binario) saidas_com_texto = true;
+    return s;
+}
+
+static FILE* abrir_arquivo(const char* caminho, const char* modo) {
+    FILE* arquivo = fopen(caminho, modo);
+    if (arquivo == NULL) {
+        perror("Falha ao abrir o arquivo de log");
+        exit(EXIT_FAILURE);
+    }
+    return arquivo;
+}
+
+// Copia para "destino" as ultimas linhas guardadas pela saida em memoria, do
+// comeco de uma linha em diante. So depois de log_esvaziar, com nada mais
+// registrando.
+size_t log_memoria(char* destino, size_t capacidade) {
+    if (saida_memoria == NULL || capacidade == 0) return 0;
+    size_t total = saida_memoria->bytes;
+    size_t guardados = total < TAMANHO_MEMORIA_LOG ? total : TAMANHO_MEMORIA_LOG;
+    if (guardados > capacidade - 1) guardados = capacidade - 1;
+
+    size_t inicio = total - guardados;
+    size_t pos = inicio % TAMANHO_MEMORIA_LOG;
+    size_t primeiro = guardados < TAMANHO_MEMORIA_LOG - pos ? guardados : TAMANHO_MEMORIA_LOG - pos;
+    memcpy(destino, saida_memoria->buffer + pos, primeiro);
+    memcpy(destino + primeiro, saida_memoria->buffer, guardados - primeiro);
+
+    size_t corte = 0;
+    if (inicio > 0) {
+        char* quebra = memchr(destino, '\n', guardados);
+        corte = quebra != NULL ? (size_t)(quebra - destino) + 1 : guardados;
+        memmove(destino, destino + corte, guardados - corte);
+    }
+    destino[guardados - corte] = '\0';
+    return guardados - corte;
+}
+
+// ------------------------- ESCRITORA -------------------------
+
+static void escrever_lote(const registro_log_t* lote, int n) {
+    static time_t ultima_data = (time_t)-1;
+    static char data[32];
+    static char texto[TAMANHO_TEXTO_LOG];
+
+    for (int i = 0; i < n; i++) {
+        const registro_log_t* r = &lote[i];
+        size_t tamanho = 0;
+        if (saidas_com_texto) {
+            if (r->data != ultima_data) {
+                struct tm t;
+                localtime_r(&r->data, &t);
+                strftime(data, sizeof(data) - 1, "%Y-%m-%d %H:%M:%S", &t);
+                ultima_data = r->data;
+            }
+            tamanho = log_formatar(formatos[r->formato].formato, r->argumentos, r->tamanho, texto, sizeof(texto));
+        }
+        for (int s = 0; s < num_saidas; s++) {
+            saidas[s].escrever(&saidas[s], r, data, texto, tamanho);
+        }
+    }
+}
+
+static void* rotina_escritora(void* arg) {
+    (void)arg;
+    static registro_log_t lote[LOTE_LOG];
+
+    for (;;) {
+        int n = 0;
+        while (n < LOTE_LOG && retirar(&lote[n])) n++;
+        size_t retirados = atomic_load(&cabeca);
+        if (n > 0) {
+            escrever_lote(lote, n);
+            lotes++;
+        }
+        // Sem trabalho, ou com log_esvaziar esperando, o que esta nos buffers
+        // vai para os arquivos.
+        bool entregar = n < LOTE_LOG || atomic_load(&aguardando_escritora) > 0;
+        if (entregar) descarregar_saidas();
+
+        pthread_mutex_lock(&log_mutex);
+        if (entregar) escritos = retirados;
+        if (atomic_load(&aguardando_escritora) > 0) pthread_cond_broadcast(&cond_espaco);
+        if (n == LOTE_LOG) {
+            pthread_mutex_unlock(&log_mutex);
+            continue;
+        }
+        if (!escritora_ativa && anel_vazio()) {
+            pthread_mutex_unlock(&log_mutex);
+            break;
+        }
+        atomic_store(&escritora_dormindo, true);
+        if (escritora_ativa && anel_vazio()) {
+            struct timespec ts;
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            ts.tv_nsec += (long)(ESPERA_ESCRITORA * 1e9);
+            if (ts.tv_nsec >= 1000000000L) {
+                ts.tv_sec++;
+                ts.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&cond_dados, &log_mutex, &ts);
+        }
+        atomic_store(&escritora_dormindo, false);
+        pthread_mutex_unlock(&log_mutex);
+    }
+    return NULL;
+}
+
+// A capacidade e arredondada para potencia de dois. "saidas" combina
+// SAIDA_LOG_*; com "binario" a saida em arquivo grava o formato binario.
+void log_init(const char* arquivo, const char* arquivo_json, size_t capacidade, politica_log_cheio politica,
+              bool binario, int saidas_escolhidas) {
+    num_saidas = 0;
+    saidas_com_texto = false;
+    saida_arquivo = NULL;
+    saida_memoria = NULL;
+    arquivo_binario = binario && (saidas_escolhidas & SAIDA_LOG_ARQUIVO);
+    formatos_gravados = 0;
+    if (saidas_escolhidas & SAIDA_LOG_ARQUIVO) {
+        saida_arquivo = abrir_saida("arquivo", abrir_arquivo(arquivo, binario ? "wb" : "w"), TAMANHO_BUFFER_SAIDA,
+                                    binario ? escrever_binario : escrever_datado);
+        if (binario) {
+            acrescentar(saida_arquivo, MAGICO_LOG_BINARIO, strlen(MAGICO_LOG_BINARIO));
+        } else {
+            const char* cabecalho = "--- Log da Simulação do Aeroporto ---\n";
+            acrescentar(saida_arquivo, cabecalho, strlen(cabecalho));
+        }
+        descarregar(saida_arquivo);
+    }
+    if (saidas_escolhidas & SAIDA_LOG_CONSOLE) {
+        abrir_saida("console", stdout, TAMANHO_BUFFER_SAIDA, escrever_console);
+    }
+    if (saidas_escolhidas & SAIDA_LOG_MEMORIA) {
+        saida_memoria = abrir_saida("memoria", NULL, TAMANHO_MEMORIA_LOG, escrever_datado);
+    }
+    if (saidas_escolhidas & SAIDA_LOG_JSON) {
+        abrir_saida("json", abrir_arquivo(arquivo_json, "w"), TAMANHO_BUFFER_SAIDA, escrever_json);
+    }
+
+    capacidade_anel = 2;
+    while (capacidade_anel < capacidade) capacidade_anel *= 2;
+    anel = malloc(capacidade_anel * sizeof(registro_log_t));
+    if (anel == NULL) {
+        perror("Falha ao alocar o anel do log");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < capacidade_anel; i++) {
+        atomic_init(&anel[i].sequencia, i);
+    }
+    atomic_init(&cauda, 0);
+    atomic_init(&cabeca, 0);
+    atomic_init(&escritora_dormindo, false);
+    atomic_init(&aguardando_escritora, 0);
+    politica_cheio = politica;
+
+    relogio_iniciar_cond(&cond_dados);
+    pthread_cond_init(&cond_espaco, NULL);
+    escritora_ativa = true;
+    pthread_create(&thread_escritora, NULL, rotina_escritora, NULL);
+}
+
+// Espera a escritora gravar tudo que ja foi registrado, para quem vai
+// escrever no stdout por fora do log.
+void log_esvaziar() {
+    if (anel == NULL) return;
+    size_t alvo = atomic_load(&cauda);
+    pthread_mutex_lock(&log_mutex);
+    atomic_fetch_add(&aguardando_escritora, 1);
+    while (escritos < alvo) {
+        pthread_cond_signal(&cond_dados);
+        pthread_cond_wait(&cond_espaco, &log_mutex);
+    }
+    atomic_fetch_sub(&aguardando_escritora, 1);
     pthread_mutex_unlock(&log_mutex);
 }
 
 void log_close() {
-    if (log_file) {
-        fprintf(log_file, "\n--- Fim do Log ---\n");
-        fclose(log_file);
+    if (anel != NULL) {
+        pthread_mutex_lock(&log_mutex);
+        escritora_ativa = false;
+        pthread_cond_signal(&cond_dados);
+        pthread_cond_broadcast(&cond_espaco);
+        pthread_mutex_unlock(&log_mutex);
+        pthread_join(thread_escritora, NULL);
+
+        char resumo[2048];
+        int tamanho = snprintf(resumo, sizeof(resumo),
+                               "[SISTEMA] Log: %lu mensagens em %lu lotes, %d formatos, %lu descartadas, "
+                               "%lu sobrescritas, %lu esperas por espaco, %lu textos truncados.\n"
+                               "[SISTEMA] Log por categoria:",
+                               atomic_load(&mensagens), lotes, num_formatos, atomic_load(&descartadas),
+                               atomic_load(&sobrescritas), atomic_load(&esperas), atomic_load(&truncadas));
+        for (int i = 0; i < NUM_CATEGORIAS_LOG; i++) {
+            controle_categoria_t* c = &controles[i];
+            tamanho += snprintf(resumo + tamanho, sizeof(resumo) - tamanho, "%s %s %lu (nivel %s", i ? "," : "",
+                                NOMES_CATEGORIAS[i], atomic_load(&c->registradas), NOMES_NIVEIS[log_niveis[i]]);
+            if (c->limite > 0) {
+                tamanho += snprintf(resumo + tamanho, sizeof(resumo) - tamanho, ", %lu acima de %d/s",
+                                    atomic_load(&c->limitadas), c->limite);
+            }
+            if (c->amostra > 1) {
+                tamanho += snprintf(resumo + tamanho, sizeof(resumo) - tamanho, ", %lu fora da amostra 1/%d",
+                                    atomic_load(&c->fora_da_amostra), c->amostra);
+            }
+            tamanho += snprintf(resumo + tamanho, sizeof(resumo) - tamanho, ")");
+        }
+        tamanho += snprintf(resumo + tamanho, sizeof(resumo) - tamanho, ".\n[SISTEMA] Saidas do log:");
+        for (int i = 0; i < num_saidas; i++) {
+            tamanho += snprintf(resumo + tamanho, sizeof(resumo) - tamanho, "%s %s %lu mensagens em %lu bytes",
+                                i ? "," : "", saidas[i].nome, saidas[i].mensagens, saidas[i].bytes);
+        }
+        tamanho += snprintf(resumo + tamanho, sizeof(resumo) - tamanho, "%s.\n", num_saidas ? "" : " nenhuma");
+
+        // Sem o arquivo, o resumo vai para o stderr.
+        if (saida_arquivo == NULL) {
+            fputs(resumo, stderr);
+        } else if (arquivo_binario) {
+            uint16_t cabecalho = (uint16_t)tamanho;
+            gravar_binario(saida_arquivo, LOG_BIN_TEXTO, &cabecalho, sizeof(cabecalho), resumo, cabecalho);
+        } else {
+            const char* rodape = "\n--- Fim do Log ---\n";
+            acrescentar(saida_arquivo, resumo, tamanho);
+            acrescentar(saida_arquivo, rodape, strlen(rodape));
+        }
+        pthread_cond_destroy(&cond_dados);
+        pthread_cond_destroy(&cond_espaco);
+        free(anel);
+        anel = NULL;
     }
-    pthread_mutex_destroy(&log_mutex);
-}
\ No newline at end of file
+    for (int i = 0; i < num_saidas; i++) {
+        descarregar(&saidas[i]);
+        if (saidas[i].arquivo != NULL && saidas[i].arquivo != stdout) fclose(saidas[i].arquivo);
+        free(saidas[i].buffer);
+    }
+    num_saidas = 0;
+    saida_arquivo = NULL;
+    saida_memoria = NULL;
+}
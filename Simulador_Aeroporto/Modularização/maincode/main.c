@@ -1,13 +1,176 @@
 #include "aeroporto.h"
 
+#define LINHAS_FIM_DO_LOG 20
+
+// Motores concorrentes em tempo real: o mesmo rotina_aviao em uma thread do
+// kernel por aviao ou em fibras sobre poucas trabalhadoras, ou o ciclo como
+// maquina de estados avancada por um pool com roubo de trabalho.
+static int executar_motor_concorrente() {
+    registro_iniciar(sizeof(aviao_t));
+    if (config.motor == MOTOR_FIBRAS) {
+        fibras_iniciar(config.trabalhadores, config.pilha_fibra);
+    } else if (config.motor == MOTOR_MAQUINA) {
+        maquina_iniciar(config.trabalhadores);
+    }
+    if (config.motor != MOTOR_MAQUINA) {
+        prazos_iniciar();
+    }
+
+#ifndef ORDEM_GLOBAL
+    pthread_t thread_detector_deadlock;
+    if (DETECTOR_ATIVO) {
+        pthread_create(&thread_detector_deadlock, NULL, thread_detectar_deadlock, NULL);
+    }
+#endif
+
+    // Threads de avioes sao destacadas: o registro libera o slot quando o
+    // aviao termina e o encerramento espera o registro esvaziar.
+    pthread_attr_t atributos_aviao;
+    pthread_attr_init(&atributos_aviao);
+    pthread_attr_setdetachstate(&atributos_aviao, PTHREAD_CREATE_DETACHED);
+
+    int contador_avioes = 0;
+    bool limite_atingido = false;
+
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "\n[SISTEMA] --- SIMULACAO INICIADA ---\n\n");
+
+    while (relogio_agora() < TEMPO_TOTAL && !limite_atingido) {
+        aviao_t* aviao = registro_obter();
+        if (aviao == NULL) {
+            perror("Falha ao alocar memoria para o aviao");
+            break;
+        }
+
+        inicializar_aviao(aviao, contador_avioes + 1);
+        log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Criado (%s), aproximando-se do aeroporto.\n",
+               aviao->ID, classes_voo[aviao->tipo].nome);
+
+        if (config.motor == MOTOR_MAQUINA) {
+            maquina_lancar_aviao(aviao);
+        } else if (config.motor == MOTOR_FIBRAS) {
+            if (fibra_criar(rotina_aviao, (void *)aviao) == -1) {
+                perror("Falha ao criar fibra do aviao");
+                registro_liberar(aviao);
+                break;
+            }
+        } else if (pthread_create(&aviao->thread_id, &atributos_aviao, rotina_aviao, (void *)aviao) != 0) {
+            perror("Falha ao criar thread do aviao");
+            registro_liberar(aviao);
+            break;
+        }
+
+        contador_avioes++;
+        if (config.max_avioes > 0 && contador_avioes == config.max_avioes) {
+            limite_atingido = true;
+        }
+        relogio_dormir(intervalo_chegada());
+    }
+
+    sistema_ativo = false;
+    fila_encerrar_envelhecimento();
+    pthread_attr_destroy(&atributos_aviao);
+
+    if (!limite_atingido)
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "\n[SISTEMA] TEMPO ESGOTADO! Nenhum aviao novo sera criado. Aguardando existentes...\n");
+    else
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "\n[SISTEMA] LIMITE DE AVIOES ATINGIDO! Aguardando existentes...\n");
+
+    if (config.motor == MOTOR_FIBRAS) {
+        fibras_aguardar();
+    } else if (config.motor == MOTOR_MAQUINA) {
+        maquina_aguardar();
+    }
+    registro_aguardar_vazio();
+    if (config.motor != MOTOR_MAQUINA) {
+        prazos_encerrar();
+    }
+
+#ifndef ORDEM_GLOBAL
+    if (DETECTOR_ATIVO) {
+        pthread_cancel(thread_detector_deadlock);
+        pthread_join(thread_detector_deadlock, NULL);
+    }
+#endif
+
+    return contador_avioes;
+}
+
+// Com a saida em memoria, as ultimas linhas do log abrem o relatorio: numa
+// execucao sem console e o que sobra para ver como ela terminou.
+static void exibir_fim_do_log() {
+    static char texto[TAMANHO_MEMORIA_LOG + 1];
+    size_t tamanho = log_memoria(texto, sizeof(texto));
+    if (tamanho == 0) return;
+
+    const char* inicio = texto + tamanho;
+    int linhas = 0;
+    while (inicio > texto && linhas <= LINHAS_FIM_DO_LOG) {
+        inicio--;
+        if (*inicio == '\n') linhas++;
+    }
+    if (*inicio == '\n') inicio++;
+    printf("\n--- Ultimas linhas do log ---\n%s", inicio);
+}
+
 int main(int argc, char* argv[]) {
-    if (argc != 8) {
-        fprintf(stderr, "Uso: %s <torres> <pistas> <portoes> <op_torres> <tempo_total> <alerta_critico> <falha>\n", argv[0]);
+    if (argc < 8 || ler_opcoes(argc, argv, 8) == -1) {
+        fprintf(stderr, "Uso: %s <torres> <pistas> <portoes> <op_torres> <tempo_total> <alerta_critico> <falha> [opcoes]\n", argv[0]);
         fprintf(stderr, "Exemplo: %s 1 3 5 2 300 60 90\n", argv[0]);
+        fprintf(stderr, "Opcoes:\n");
+        fprintf(stderr, "  --motor=threads|eventos|fibras|maquina\n");
+        fprintf(stderr, "                            uma thread por aviao (padrao), eventos discretos em tempo\n");
+        fprintf(stderr, "                            virtual, avioes como fibras sobre poucas threads, ou\n");
+        fprintf(stderr, "                            maquinas de estado em um pool com roubo de trabalho\n");
+        fprintf(stderr, "  --fila=heap|lista|baldes|skiplist\n");
+        fprintf(stderr, "                            filas de prioridade em heap indexado (padrao), lista ordenada,\n");
+        fprintf(stderr, "                            baldes por nivel ou skiplist sem travas\n");
+        fprintf(stderr, "  --aquisicao=passos|conjunto|ordenada|banqueiro\n");
+        fprintf(stderr, "                            recursos de cada operacao um a um na ordem da rota (padrao),\n");
+        fprintf(stderr, "                            todos juntos em um unico pedido, um a um em uma ordem global,\n");
+        fprintf(stderr, "                            ou um a um so quando o estado continua seguro (usa --fila=lista);\n");
+        fprintf(stderr, "                            o detector de deadlock so roda com passos\n");
+        fprintf(stderr, "  --ordem=R,R,R             ordem global de pista, portao e torre (padrao: torre,portao,pista)\n");
+        fprintf(stderr, "  --classe=C:P[:T[:W]]      prioridade base P (0-%d), taxa de envelhecimento T e peso W nas\n", NUM_BALDES - 1);
+        fprintf(stderr, "                            chegadas da classe C: domestico, internacional, emergencia,\n");
+        fprintf(stderr, "                            medico, carga ou geral (padrao: so domestico e internacional)\n");
+        fprintf(stderr, "  --envelhecimento=degraus|X\n");
+        fprintf(stderr, "                            a cada segundo, +2 por 5s de espera depois da carencia e o bonus\n");
+        fprintf(stderr, "                            depois do limiar (padrao), ou X pontos por segundo de espera e o\n");
+        fprintf(stderr, "                            bonus uma vez (a taxa T de --classe so vale aqui; exigido pela skiplist)\n");
+        fprintf(stderr, "  --carencia=S              espera sem envelhecer nos degraus (padrao: 10)\n");
+        fprintf(stderr, "  --bonus-espera=N          bonus para esperas longas (padrao: 10)\n");
+        fprintf(stderr, "  --limiar-bonus=S          espera que da direito ao bonus (padrao: alerta_critico/2)\n");
+        fprintf(stderr, "  --semente=N               semente do gerador aleatorio\n");
+        fprintf(stderr, "  --escala=X                tempo simulado corre X vezes mais rapido (motores em tempo real)\n");
+        fprintf(stderr, "  --trabalhadores=N         threads trabalhadoras de fibras e maquina (padrao: uma por nucleo)\n");
+        fprintf(stderr, "  --pilha-fibra=KB          tamanho da pilha de cada fibra (padrao: 64)\n");
+        fprintf(stderr, "  --max-avioes=N            para de criar avioes depois de N (padrao: sem limite)\n");
+        fprintf(stderr, "  --fator-chegadas=K        chegadas K vezes mais frequentes (padrao: 1)\n");
+        fprintf(stderr, "  --log-capacidade=N        mensagens no anel do log ate a escrita (padrao: %d)\n",
+                CAPACIDADE_LOG_PADRAO);
+        fprintf(stderr, "  --log-cheio=bloquear|descartar|sobrescrever\n");
+        fprintf(stderr, "                            com o anel cheio, espera a escrita (padrao), descarta a\n");
+        fprintf(stderr, "                            mensagem nova ou descarta a mais antiga\n");
+        fprintf(stderr, "  --log-nivel=[C:]N         nivel maximo (erro, aviso, info, detalhe) de todas as categorias\n");
+        fprintf(stderr, "                            ou so da categoria C: sistema, aviao, recurso, alerta, deadlock\n");
+        fprintf(stderr, "  --log-limite=C:N          no maximo N mensagens da categoria C por segundo simulado\n");
+        fprintf(stderr, "  --log-amostra=C:N         so uma de cada N mensagens da categoria C\n");
+        fprintf(stderr, "  --log-saida=S[,S...]      para onde vai o log: arquivo (simulacao.log), console, memoria\n");
+        fprintf(stderr, "                            (ultimas linhas antes do relatorio), json (simulacao.jsonl)\n");
+        fprintf(stderr, "                            ou nulo (padrao: arquivo,console)\n");
+        fprintf(stderr, "  --log-binario             o arquivo vira simulacao.bin, sem formatar nada e, por padrao,\n");
+        fprintf(stderr, "                            sem console; bin/decodificar_log gera o simulacao.log depois\n");
+        fprintf(stderr, "  --rastro                  grava em simulacao.rastro cada pedido, concessao, liberacao,\n");
+        fprintf(stderr, "                            alerta, falha, impasse e realocacao; bin/ler_rastro gera um CSV\n");
         return 1;
     }
     
-    log_init("simulacao.log");
+    relogio_iniciar(config.motor == MOTOR_EVENTOS, config.escala_tempo);
+    log_init(config.log_binario ? "simulacao.bin" : "simulacao.log", "simulacao.jsonl", config.log_capacidade,
+             config.log_cheio, config.log_binario, config.log_saidas);
+    if (config.rastro) {
+        rastro_iniciar("simulacao.rastro");
+    }
 
     NUM_TORRES = atoi(argv[1]);
     NUM_PISTAS = atoi(argv[2]);
@@ -16,117 +179,125 @@ int main(int argc, char* argv[]) {
     TEMPO_TOTAL = atoi(argv[5]);
     ALERTA_CRITICO = atoi(argv[6]);
     FALHA = atoi(argv[7]);
+    if (config.limiar_bonus < 0) config.limiar_bonus = ALERTA_CRITICO / 2;
+
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "======================================================\n");
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "     SIMULACAO DE CONTROLE DE TRAFEGO AEREO\n");
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "======================================================\n\n");
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Parametros da simulacao:\n");
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "------------------------------------------------------\n");
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "- Torres de Controle: %d\n", NUM_TORRES);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "- Pistas: %d\n", NUM_PISTAS);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "- Portoes: %d\n", NUM_PORTOES);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "- Operacoes simultaneas por Torre: %d\n", NUM_OP_TORRES);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "- Tempo total de simulacao: %d segundos\n", TEMPO_TOTAL);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "- Tempo para alerta critico: %d segundos\n", ALERTA_CRITICO);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "- Tempo para falha: %d segundos\n", FALHA);
+    if (config.envelhecimento == ENVELHECIMENTO_DEGRAUS) {
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "- Envelhecimento: em degraus apos %ds de espera, bonus de %d por segundo apos %ds\n",
+               config.carencia, config.bonus_espera, config.limiar_bonus);
+    } else {
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "- Envelhecimento: %.2f pontos/s, bonus de %d apos %ds de espera\n",
+               config.taxa_envelhecimento, config.bonus_espera, config.limiar_bonus);
+    }
+    for (int i = 0; i < NUM_CLASSES_VOO; i++) {
+        if (classes_voo[i].peso == 0) continue;
+        if (config.envelhecimento == ENVELHECIMENTO_DEGRAUS) {
+            log_evento(LOG_SISTEMA, NIVEL_INFO, "- Classe %s: prioridade %d, peso %d\n", classes_voo[i].nome,
+                   classes_voo[i].prioridade_base, classes_voo[i].peso);
+            continue;
+        }
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "- Classe %s: prioridade %d, envelhecimento %.2f pontos/s, peso %d\n", classes_voo[i].nome,
+               classes_voo[i].prioridade_base, taxa_da_classe((tipo_de_voo)i), classes_voo[i].peso);
+    }
+    if (config.motor == MOTOR_EVENTOS)
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "- Motor: eventos discretos (tempo virtual)\n");
+    else if (config.motor == MOTOR_FIBRAS)
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "- Motor: fibras em %d trabalhadoras (escala de tempo %.1fx)\n",
+               config.trabalhadores, config.escala_tempo);
+    else if (config.motor == MOTOR_MAQUINA)
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "- Motor: maquinas de estado em %d trabalhadoras (escala de tempo %.1fx)\n",
+               config.trabalhadores, config.escala_tempo);
+    else
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "- Motor: threads (escala de tempo %.1fx)\n", config.escala_tempo);
+    if (config.aquisicao == AQUISICAO_CONJUNTO)
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "- Aquisicao: conjunto (todos os recursos da operacao em um pedido)\n");
+    else if (config.aquisicao == AQUISICAO_BANQUEIRO)
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "- Aquisicao: banqueiro (um recurso por vez, so em estado seguro; filas em lista)\n");
+    else if (config.aquisicao == AQUISICAO_ORDENADA)
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "- Aquisicao: ordenada (%s, %s, %s; sem detector de deadlock)\n",
+               nome_do_recurso(config.ordem_global[0]), nome_do_recurso(config.ordem_global[1]),
+               nome_do_recurso(config.ordem_global[2]));
+    else
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "- Aquisicao: passos (um recurso por vez, na ordem da rota)\n");
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "------------------------------------------------------\n\n");
 
-    log_message("======================================================\n");
-    log_message("     SIMULACAO DE CONTROLE DE TRAFEGO AEREO\n");
-    log_message("======================================================\n\n");
-    log_message("[SISTEMA] Parametros da simulacao:\n");
-    log_message("------------------------------------------------------\n");
-    log_message("- Torres de Controle: %d\n", NUM_TORRES);
-    log_message("- Pistas: %d\n", NUM_PISTAS);
-    log_message("- Portoes: %d\n", NUM_PORTOES);
-    log_message("- Operacoes simultaneas por Torre: %d\n", NUM_OP_TORRES);
-    log_message("- Tempo total de simulacao: %d segundos\n", TEMPO_TOTAL);
-    log_message("- Tempo para alerta critico: %d segundos\n", ALERTA_CRITICO);
-    log_message("- Tempo para falha: %d segundos\n", FALHA);
-    log_message("------------------------------------------------------\n\n");
-
-    log_message("[SISTEMA] Inicializando simulacao...\n");
-    sem_init(&sem_pistas, 0, NUM_PISTAS);
-    sem_init(&sem_portoes, 0, NUM_PORTOES);
-    sem_init(&sem_torre_ops, 0, NUM_OP_TORRES);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Inicializando simulacao...\n");
     pthread_mutex_init(&mutex_lista_avioes, NULL);
     pthread_mutex_init(&mutex_contadores, NULL);
     pthread_mutex_init(&mutex_warnings, NULL);
-    memset(avioes_com_warnings, 0, sizeof(avioes_com_warnings));
 
     inicializar_fila(&fila_pistas);
     inicializar_fila(&fila_portoes);
     inicializar_fila(&fila_torre_ops);
+    inicializar_recurso(&recurso_pistas, RECURSO_PISTA, &fila_pistas, NUM_PISTAS);
+    inicializar_recurso(&recurso_portoes, RECURSO_PORTAO, &fila_portoes, NUM_PORTOES);
+    inicializar_recurso(&recurso_torre_ops, RECURSO_TORRE, &fila_torre_ops, NUM_OP_TORRES);
+    inicializar_conjuntos(NUM_PISTAS, NUM_PORTOES, NUM_OP_TORRES);
+    inicializar_banqueiro(NUM_PISTAS, NUM_PORTOES, NUM_OP_TORRES);
     inicializar_detector_deadlock();
-
-    pthread_t thread_aging;
-    pthread_t thread_detector_deadlock;
-    pthread_create(&thread_aging, NULL, thread_aging_func, NULL);
-    pthread_create(&thread_detector_deadlock, NULL, thread_detectar_deadlock, NULL);
-
-    aviao_t* avioes[MAX_AVIOES];
-    int contador_avioes = 0;
-    bool limite_atingido = false;
-
-    srand(time(NULL));
-    time_t inicio_simulacao = time(NULL);
-
-    log_message("\n[SISTEMA] --- SIMULACAO INICIADA ---\n\n");
-
-    while (time(NULL) - inicio_simulacao < TEMPO_TOTAL && !limite_atingido) {
-        if (contador_avioes < MAX_AVIOES) {
-            avioes[contador_avioes] = malloc(sizeof(aviao_t));
-            if (avioes[contador_avioes] == NULL) {
-                perror("Falha ao alocar memoria para o aviao");
-                continue;
-            }
-
-            avioes[contador_avioes]->ID = contador_avioes + 1;
-            avioes[contador_avioes]->tipo = (rand() % 2 == 0) ? INTERNACIONAL : DOMESTICO;
-            avioes[contador_avioes]->em_alerta = false;
-            avioes[contador_avioes]->tempo_de_criacao = time(NULL);
-            avioes[contador_avioes]->estado = VOANDO;
-            avioes[contador_avioes]->deadlock_warnings = 0;
-            avioes[contador_avioes]->recursos_realocados = false;
-            memset(avioes[contador_avioes]->recursos_alocados, 0, sizeof(avioes[contador_avioes]->recursos_alocados));
-
-            pthread_create(&avioes[contador_avioes]->thread_id, NULL, rotina_aviao, (void *)avioes[contador_avioes]);
-
-            log_message("[AVIAO %03d] Criado (%s), aproximando-se do aeroporto.\n",
-                   avioes[contador_avioes]->ID,
-                   avioes[contador_avioes]->tipo == INTERNACIONAL ? "Internacional" : "Domestico");
-
-            contador_avioes++;
-            if (contador_avioes == MAX_AVIOES) {
-                limite_atingido = true;
-            }
-        }
-        usleep(rand() % 800000 + 500000);
+    if (config.aquisicao == AQUISICAO_ORDENADA) {
+        definir_ordem_global(config.ordem_global);
     }
 
-    sistema_ativo = false;
+    int contador_avioes;
 
-    if (!limite_atingido)
-        log_message("\n[SISTEMA] TEMPO ESGOTADO! Nenhum aviao novo sera criado. Aguardando existentes...\n");
-    else
-        log_message("\n[SISTEMA] LIMITE DE AVIOES ATINGIDO! Aguardando existentes...\n");
+    srand(config.semente);
 
-    for (int i = 0; i < contador_avioes; i++) {
-        pthread_join(avioes[i]->thread_id, NULL);
+    if (config.motor == MOTOR_EVENTOS) {
+        contador_avioes = executar_motor_eventos();
+    } else {
+        contador_avioes = executar_motor_concorrente();
     }
 
-    pthread_cancel(thread_aging);
-    pthread_cancel(thread_detector_deadlock);
-    pthread_join(thread_aging, NULL);
-    pthread_join(thread_detector_deadlock, NULL);
-
-    log_message("\n[SISTEMA] SIMULACAO FINALIZADA! Todos os avioes concluintes suas operacoes.\n");
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "\n[SISTEMA] SIMULACAO FINALIZADA! Todos os avioes concluintes suas operacoes.\n");
 
-    sem_destroy(&sem_pistas);
-    sem_destroy(&sem_portoes);
-    sem_destroy(&sem_torre_ops);
+    if (config.aquisicao == AQUISICAO_CONJUNTO) {
+        conjuntos_registrar_estatisticas();
+    } else {
+        recurso_registrar_estatisticas(&recurso_pistas);
+        recurso_registrar_estatisticas(&recurso_portoes);
+        recurso_registrar_estatisticas(&recurso_torre_ops);
+    }
+    if (DETECTOR_ATIVO) {
+        detector_registrar_estatisticas();
+    }
+    if (config.aquisicao == AQUISICAO_BANQUEIRO) {
+        banqueiro_registrar_estatisticas();
+    }
+    rastro_encerrar();
     destruir_fila(&fila_pistas);
     destruir_fila(&fila_portoes);
     destruir_fila(&fila_torre_ops);
+    destruir_conjuntos();
+    destruir_banqueiro();
+    skiplist_liberar_memoria();
 
-    exibir_relatorio_final(avioes, contador_avioes);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] %d avioes criados, %lu requisicoes de recurso, %lu alocacoes no heap para avioes e requisicoes.\n",
+           contador_avioes, atomic_load(&requisicoes_feitas), atomic_load(&alocacoes_heap));
+    registro_destruir();
+    destruir_detector_deadlock();
 
-    for (int i = 0; i < contador_avioes; i++) {
-        free(avioes[i]);
-    }
+    // O relatorio vai direto para o stdout, depois de tudo que esta no log.
+    log_esvaziar();
+    exibir_fim_do_log();
+    exibir_relatorio_final();
 
     pthread_mutex_destroy(&mutex_lista_avioes);
     pthread_mutex_destroy(&mutex_contadores);
     pthread_mutex_destroy(&mutex_warnings);
-    pthread_mutex_destroy(&detector.mutex);
 
     log_close();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,680 @@
+#include "aeroporto.h"
+#include "temporizador.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+// --------------------- MOTOR DE MAQUINAS DE ESTADO ---------------------
+// Cada aviao e um registro com a etapa atual do ciclo. Um conjunto fixo de
+// trabalhadoras, cada uma com seu deque (Chase-Lev) e roubo de trabalho,
+// avanca os registros. Um aviao que nao consegue pista/portao/torre fica
+// estacionado na fila do recurso e nao ocupa thread nenhuma; quem libera o
+// recurso devolve o aviao a um deque.
+
+typedef enum {
+    ETAPA_INICIAR_OPERACAO,
+    ETAPA_SOLICITAR,
+    ETAPA_RECURSO_OBTIDO,
+    ETAPA_FIM_OPERACAO,
+    ETAPA_LIBERAR_PORTAO,
+    ETAPA_PREEMPTADO,
+    ETAPA_FALHA
+} etapa_aviao;
+
+// Estado da espera nos 2 bits baixos, ticket da espera no restante: um prazo
+// de falha antigo nao consegue expirar uma espera nova.
+#define ESPERA_NENHUMA     0UL
+#define ESPERA_AGUARDANDO  1UL
+#define ESPERA_CONCEDIDA   2UL
+#define ESPERA_EXPIRADA    3UL
+#define ESPERA_ESTADO(v)   ((v) & 3UL)
+
+enum {
+    TEMPO_ETAPA,
+    TEMPO_BONUS,
+    TEMPO_ALERTA,
+    TEMPO_FALHA
+};
+
+typedef struct aviao_maquina {
+    aviao_t aviao;              // primeiro campo: a fila guarda aviao_t*
+    tipo_operacao operacao;
+    etapa_aviao etapa;
+    int passo;
+    tipo_recurso recurso_aguardado;
+    double inicio_espera;
+    _Atomic unsigned long espera;
+    struct aviao_maquina* proximo_injetado;
+} aviao_maquina_t;
+
+// ------------------------- DEQUE CHASE-LEV -------------------------
+typedef struct vetor_deque {
+    long capacidade;
+    struct vetor_deque* anterior;   // vetores antigos: ladroes ainda podem le-los
+    _Atomic(aviao_maquina_t*) itens[];
+} vetor_deque_t;
+
+typedef struct {
+    _Atomic long topo;
+    _Atomic long base;
+    _Atomic(vetor_deque_t*) vetor;
+    char separador[64 - 2 * sizeof(long) - sizeof(void*)];
+} deque_t;
+
+#define ROUBO_ABORTADO ((aviao_maquina_t*)1)
+
+static vetor_deque_t* novo_vetor(long capacidade, vetor_deque_t* anterior) {
+    vetor_deque_t* v = malloc(sizeof(vetor_deque_t) + capacidade * sizeof(aviao_maquina_t*));
+    if (v == NULL) {
+        perror("Falha ao alocar deque de trabalho");
+        exit(EXIT_FAILURE);
+    }
+    v->capacidade = capacidade;
+    v->anterior = anterior;
+    return v;
+}
+
+static void deque_iniciar(deque_t* d) {
+    atomic_init(&d->topo, 0);
+    atomic_init(&d->base, 0);
+    atomic_init(&d->vetor, novo_vetor(1024, NULL));
+}
+
+static void deque_destruir(deque_t* d) {
+    vetor_deque_t* v = atomic_load(&d->vetor);
+    while (v != NULL) {
+        vetor_deque_t* anterior = v->anterior;
+        free(v);
+        v = anterior;
+    }
+}
+
+// So a dona do deque empilha e desempilha pela base.
+static void deque_empurrar(deque_t* d, aviao_maquina_t* am) {
+    long b = atomic_load_explicit(&d->base, memory_order_relaxed);
+    long t = atomic_load_explicit(&d->topo, memory_order_acquire);
+    vetor_deque_t* v = atomic_load_explicit(&d->vetor, memory_order_relaxed);
+
+    if (b - t > v->capacidade - 1) {
+        vetor_deque_t* maior = novo_vetor(v->capacidade * 2, v);
+        for (long i = t; i < b; i++) {
+            atomic_store_explicit(&maior->itens[i % maior->capacidade],
+                                  atomic_load_explicit(&v->itens[i % v->capacidade], memory_order_relaxed),
+                                  memory_order_relaxed);
+        }
+        atomic_store_explicit(&d->vetor, maior, memory_order_release);
+        v = maior;
+    }
+    atomic_store_explicit(&v->itens[b % v->capacidade], am, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&d->base, b + 1, memory_order_relaxed);
+}
+
+static aviao_maquina_t* deque_tomar(deque_t* d) {
+    long b = atomic_load_explicit(&d->base, memory_order_relaxed) - 1;
+    vetor_deque_t* v = atomic_load_explicit(&d->vetor, memory_order_relaxed);
+    atomic_store_explicit(&d->base, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&d->topo, memory_order_relaxed);
+
+    aviao_maquina_t* am = NULL;
+    if (t <= b) {
+        am = atomic_load_explicit(&v->itens[b % v->capacidade], memory_order_relaxed);
+        if (t == b) {
+            if (!atomic_compare_exchange_strong_explicit(&d->topo, &t, t + 1,
+                                                         memory_order_seq_cst, memory_order_relaxed)) {
+                am = NULL;
+            }
+            atomic_store_explicit(&d->base, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&d->base, b + 1, memory_order_relaxed);
+    }
+    return am;
+}
+
+static aviao_maquina_t* deque_roubar(deque_t* d) {
+    long t = atomic_load_explicit(&d->topo, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&d->base, memory_order_acquire);
+
+    if (t >= b) return NULL;
+
+    vetor_deque_t* v = atomic_load_explicit(&d->vetor, memory_order_acquire);
+    aviao_maquina_t* am = atomic_load_explicit(&v->itens[t % v->capacidade], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->topo, &t, t + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return ROUBO_ABORTADO;
+    }
+    return am;
+}
+
+// ----------------------------- POOL -----------------------------
+static int num_trabalhadoras = 0;
+static pthread_t* trabalhadoras = NULL;
+static deque_t* deques = NULL;
+static __thread int indice_trabalhadora = -1;
+
+// mutex_pool protege a fila de injecao (avioes tornados prontos fora das
+// trabalhadoras), a agenda de prazos, as ociosas e o encerramento.
+static pthread_mutex_t mutex_pool = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_pool;
+static pthread_cond_t cond_fim;
+static aviao_maquina_t* injecao_inicio = NULL;
+static aviao_maquina_t* injecao_fim = NULL;
+static agenda_t agenda;
+static _Atomic int ociosas = 0;
+static bool encerrando = false;
+static long avioes_ativos = 0;
+
+static _Atomic unsigned long etapas_executadas = 0;
+static _Atomic unsigned long roubos = 0;
+
+static void acordar_ociosa() {
+    pthread_mutex_lock(&mutex_pool);
+    if (ociosas > 0) {
+        pthread_cond_signal(&cond_pool);
+    }
+    pthread_mutex_unlock(&mutex_pool);
+}
+
+static void injetar(aviao_maquina_t* am) {
+    pthread_mutex_lock(&mutex_pool);
+    am->proximo_injetado = NULL;
+    if (injecao_fim) injecao_fim->proximo_injetado = am; else injecao_inicio = am;
+    injecao_fim = am;
+    pthread_cond_signal(&cond_pool);
+    pthread_mutex_unlock(&mutex_pool);
+}
+
+// Depois de tornar_pronto o aviao pertence a outra etapa; quem chamou nao
+// pode mais toca-lo.
+static void tornar_pronto(aviao_maquina_t* am) {
+    if (indice_trabalhadora >= 0) {
+        deque_empurrar(&deques[indice_trabalhadora], am);
+        if (ociosas > 0) {
+            acordar_ociosa();
+        }
+    } else {
+        injetar(am);
+    }
+}
+
+static void agendar(double segundos, void* alvo, unsigned long marca, int tipo) {
+    struct timespec ts;
+    relogio_prazo(segundos, &ts);
+    double prazo = ts.tv_sec + ts.tv_nsec / 1e9;
+
+    pthread_mutex_lock(&mutex_pool);
+    if (agenda_inserir(&agenda, prazo, alvo, marca, tipo)) {
+        pthread_cond_signal(&cond_pool);
+    }
+    pthread_mutex_unlock(&mutex_pool);
+}
+
+static void mudar_estado(aviao_maquina_t* am, estado_aviao estado) {
+    pthread_mutex_lock(&mutex_lista_avioes);
+    am->aviao.estado = estado;
+    pthread_mutex_unlock(&mutex_lista_avioes);
+}
+
+static void aviao_terminou(aviao_maquina_t* am) {
+    aviao_finalizado(&am->aviao);
+
+    pthread_mutex_lock(&mutex_pool);
+    avioes_ativos--;
+    if (avioes_ativos == 0) {
+        pthread_cond_broadcast(&cond_fim);
+    }
+    pthread_mutex_unlock(&mutex_pool);
+}
+
+// ----------------------------- RECURSOS -----------------------------
+static const char* nome_aguardado(const aviao_maquina_t* am) {
+    if (config.aquisicao == AQUISICAO_CONJUNTO) return RECURSOS_OPERACAO[am->operacao];
+    return nome_do_recurso(am->recurso_aguardado);
+}
+
+static int recurso_aguardado_rastro(const aviao_maquina_t* am) {
+    if (config.aquisicao == AQUISICAO_CONJUNTO) return RECURSO_RASTRO_NENHUM;
+    return am->recurso_aguardado;
+}
+
+// A espera so e encerrada uma vez: pela concessao ou pelo prazo de falha.
+static bool encerrar_espera(aviao_maquina_t* am) {
+    unsigned long espera = atomic_load(&am->espera);
+    return ESPERA_ESTADO(espera) == ESPERA_AGUARDANDO &&
+           atomic_compare_exchange_strong(&am->espera, &espera, (espera & ~3UL) | ESPERA_CONCEDIDA);
+}
+
+static void registrar_posse(aviao_maquina_t* am, tipo_recurso recurso) {
+    limpar_requisicao(&am->aviao, recurso);
+    registrar_alocacao(&am->aviao, recurso);
+    log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] alocou %s com sucesso.\n",
+           am->aviao.ID, nome_do_recurso(recurso));
+    rastrear(RASTRO_CONCESSAO, &am->aviao, recurso, 0);
+}
+
+// Entrega a unidade ao aviao se a espera ainda esta de pe; se o prazo de
+// falha ganhou, quem tem a unidade deve repassa-la.
+static bool conceder(aviao_maquina_t* am, tipo_recurso recurso) {
+    if (!encerrar_espera(am)) return false;
+
+    registrar_posse(am, recurso);
+    am->etapa = ETAPA_RECURSO_OBTIDO;
+    tornar_pronto(am);
+    return true;
+}
+
+// O mesmo para o conjunto da operacao: ETAPA_RECURSO_OBTIDO no ultimo passo
+// leva o aviao direto a operacao.
+static bool conceder_conjunto(aviao_maquina_t* am) {
+    if (!encerrar_espera(am)) return false;
+
+    for (int r = 0; r < 3; r++) {
+        if (CONJUNTO_OPERACAO[am->operacao] & (1 << r)) registrar_posse(am, (tipo_recurso)r);
+    }
+    am->passo = NUM_PASSOS_OPERACAO[am->operacao] - 1;
+    am->etapa = ETAPA_RECURSO_OBTIDO;
+    tornar_pronto(am);
+    return true;
+}
+
+static bool repasse_concedido(request_node_t* no) {
+    if (no->recursos != 0) {
+        return conceder_conjunto((aviao_maquina_t*)no->aviao);
+    }
+    return conceder((aviao_maquina_t*)no->aviao, no->recurso_desejado);
+}
+
+// O detector tirou o aviao da fila. A espera termina como no prazo de falha
+// (um dos dois ganha), mas o aviao segue para a devolucao e recomeca.
+static bool preempcao_pedida(request_node_t* no) {
+    aviao_maquina_t* am = (aviao_maquina_t*)no->aviao;
+    unsigned long espera = atomic_load(&am->espera);
+    if (ESPERA_ESTADO(espera) != ESPERA_AGUARDANDO ||
+        !atomic_compare_exchange_strong(&am->espera, &espera, (espera & ~3UL) | ESPERA_EXPIRADA)) {
+        return false;
+    }
+    am->etapa = ETAPA_PREEMPTADO;
+    tornar_pronto(am);
+    return true;
+}
+
+static void liberar(aviao_maquina_t* am, tipo_recurso recurso) {
+    registrar_liberacao(&am->aviao, recurso);
+    liberar_recurso_com_prioridade(recurso_do_tipo(recurso), &am->aviao);
+}
+
+// ---------------------------- CICLO DO AVIAO ----------------------------
+static void iniciar_espera(aviao_maquina_t* am) {
+    adicionar_aviao_warning(&am->aviao);
+
+    unsigned long ticket = (atomic_load(&am->espera) >> 2) + 1;
+    am->inicio_espera = relogio_agora();
+    atomic_store(&am->espera, (ticket << 2) | ESPERA_AGUARDANDO);
+    agendar(config.limiar_bonus, am, ticket, TEMPO_BONUS);
+    agendar(ALERTA_CRITICO, am, ticket, TEMPO_ALERTA);
+    agendar(FALHA, am, ticket, TEMPO_FALHA);
+}
+
+// --aquisicao=conjunto: a operacao inteira em um pedido.
+static void solicitar_conjunto(aviao_maquina_t* am) {
+    int recursos = CONJUNTO_OPERACAO[am->operacao];
+
+    log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] solicitou %s.\n",
+           am->aviao.ID, RECURSOS_OPERACAO[am->operacao]);
+    if (am->aviao.recursos_realocados && am->aviao.tipo == DOMESTICO) {
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Aviao [%03d] (domestico realocado) tem prioridade maxima.\n",
+               am->aviao.ID);
+    }
+
+    for (int r = 0; r < 3; r++) {
+        if (!(recursos & (1 << r))) continue;
+        registrar_requisicao(&am->aviao, (tipo_recurso)r);
+        rastrear(RASTRO_PEDIDO, &am->aviao, r, 0);
+    }
+    iniciar_espera(am);
+
+    int resultado = conjunto_solicitar(&am->aviao, recursos);
+    if (resultado == -1) {
+        perror("Falha ao alocar requisicao");
+        exit(EXIT_FAILURE);
+    }
+    if (resultado == 1 && !conceder_conjunto(am)) {
+        conjunto_devolver(recursos);
+    }
+}
+
+// Tudo que o aviao precisa fica pronto antes de ele entrar na fila: a partir
+// de recurso_solicitar outra trabalhadora pode conceder e avanca-lo.
+static void solicitar(aviao_maquina_t* am) {
+    if (config.aquisicao == AQUISICAO_CONJUNTO) {
+        solicitar_conjunto(am);
+        return;
+    }
+
+    tipo_recurso recurso = ORDEM_RECURSOS[am->operacao][am->aviao.rota][am->passo];
+
+    log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] solicitou %s.\n",
+           am->aviao.ID, nome_do_recurso(recurso));
+    rastrear(RASTRO_PEDIDO, &am->aviao, recurso, 0);
+    if (am->aviao.recursos_realocados && am->aviao.tipo == DOMESTICO) {
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Aviao [%03d] (domestico realocado) tem prioridade maxima.\n",
+               am->aviao.ID);
+    }
+
+    registrar_requisicao(&am->aviao, recurso);
+    am->recurso_aguardado = recurso;
+    iniciar_espera(am);
+
+    int resultado = recurso_solicitar(recurso_do_tipo(recurso), &am->aviao);
+    if (resultado == -1) {
+        perror("Falha ao alocar requisicao");
+        exit(EXIT_FAILURE);
+    }
+    if (resultado == 1 && !conceder(am, recurso)) {
+        banqueiro_desfazer(&am->aviao, recurso);
+        recurso_devolver(recurso_do_tipo(recurso));
+    }
+}
+
+static void falhar(aviao_maquina_t* am) {
+    mudar_estado(am, FALHA_OPERACIONAL);
+
+    pthread_mutex_lock(&mutex_contadores);
+    contador_starvation++;
+    pthread_mutex_unlock(&mutex_contadores);
+
+    if (config.aquisicao == AQUISICAO_CONJUNTO) {
+        conjunto_desistir(&am->aviao);
+        for (int r = 0; r < 3; r++) {
+            if (CONJUNTO_OPERACAO[am->operacao] & (1 << r)) limpar_requisicao(&am->aviao, (tipo_recurso)r);
+        }
+    } else {
+        remover_requisicao(fila_do_recurso(am->recurso_aguardado), &am->aviao);
+        limpar_requisicao(&am->aviao, am->recurso_aguardado);
+    }
+
+    log_evento(LOG_ALERTA, NIVEL_ERRO, "[ALERTA] FALHA OPERACIONAL POR STARVATION: Aviao [%03d] excedeu tempo limite esperando por %s (%lds).\n",
+           am->aviao.ID, nome_aguardado(am), (long)(relogio_agora() - am->inicio_espera));
+    rastrear(RASTRO_FALHA, &am->aviao, recurso_aguardado_rastro(am),
+             (int)(relogio_agora() - am->inicio_espera));
+
+    for (int i = am->passo - 1; i >= 0; i--) {
+        liberar(am, ORDEM_RECURSOS[am->operacao][am->aviao.rota][i]);
+    }
+    banqueiro_encerrar(&am->aviao);
+    log_evento(LOG_AVIAO, NIVEL_AVISO, "[AVIAO %03d] Falha ao obter recursos para %s. Abortando.\n",
+           am->aviao.ID, NOME_OPERACAO[am->operacao]);
+
+    aviao_terminou(am);
+}
+
+// Avanca o aviao ate ele estacionar (fila de recurso ou prazo) ou terminar.
+static void avancar(aviao_maquina_t* am) {
+    static const estado_aviao ESTADOS[3] = { POUSANDO, DESEMBARCANDO, DECOLANDO };
+
+    while (1) {
+        switch (am->etapa) {
+            case ETAPA_INICIAR_OPERACAO:
+                log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Iniciando procedimento de %s.\n",
+                       am->aviao.ID, NOME_OPERACAO[am->operacao]);
+                mudar_estado(am, ESTADOS[am->operacao]);
+                am->passo = 0;
+                am->etapa = ETAPA_SOLICITAR;
+                if (config.aquisicao != AQUISICAO_CONJUNTO) {
+                    banqueiro_declarar(&am->aviao, CONJUNTO_OPERACAO[am->operacao]);
+                }
+                break;
+
+            case ETAPA_SOLICITAR:
+                solicitar(am);
+                return;
+
+            case ETAPA_RECURSO_OBTIDO:
+                am->passo++;
+                if (am->passo < NUM_PASSOS_OPERACAO[am->operacao]) {
+                    am->etapa = ETAPA_SOLICITAR;
+                    break;
+                }
+                log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Obteve todos os recursos para %s.\n",
+                       am->aviao.ID, RECURSOS_OPERACAO[am->operacao]);
+                log_evento(LOG_AVIAO, NIVEL_INFO, MENSAGEM_ANDAMENTO[am->operacao], am->aviao.ID);
+                am->etapa = ETAPA_FIM_OPERACAO;
+                agendar(DURACAO_OPERACAO[am->operacao], am, 0, TEMPO_ETAPA);
+                return;
+
+            case ETAPA_FIM_OPERACAO:
+                if (am->operacao == OP_POUSO) {
+                    liberar(am, RECURSO_PISTA);
+                    liberar(am, RECURSO_TORRE);
+                    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Pouso concluido. Recursos liberados.\n",
+                           am->aviao.ID);
+                    am->operacao = OP_DESEMBARQUE;
+                    am->etapa = ETAPA_INICIAR_OPERACAO;
+                    break;
+                }
+                if (am->operacao == OP_DESEMBARQUE) {
+                    liberar(am, RECURSO_TORRE);
+                    am->etapa = ETAPA_LIBERAR_PORTAO;
+                    agendar(2, am, 0, TEMPO_ETAPA);
+                    return;
+                }
+                liberar(am, RECURSO_PORTAO);
+                liberar(am, RECURSO_PISTA);
+                liberar(am, RECURSO_TORRE);
+                log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Decolagem concluida. Recursos liberados.\n",
+                       am->aviao.ID);
+                mudar_estado(am, CONCLUIDO);
+                log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Todas as operacoes foram concluidas com sucesso.\n",
+                       am->aviao.ID);
+                aviao_terminou(am);
+                return;
+
+            case ETAPA_LIBERAR_PORTAO:
+                liberar(am, RECURSO_PORTAO);
+                log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Desembarque concluido. Recursos liberados.\n",
+                       am->aviao.ID);
+                am->operacao = OP_DECOLAGEM;
+                am->etapa = ETAPA_INICIAR_OPERACAO;
+                break;
+
+            case ETAPA_PREEMPTADO:
+                limpar_requisicao(&am->aviao, am->recurso_aguardado);
+                for (int i = am->passo - 1; i >= 0; i--) {
+                    liberar(am, ORDEM_RECURSOS[am->operacao][am->aviao.rota][i]);
+                }
+                aviao_preemptado(&am->aviao, am->operacao);
+                am->passo = 0;
+                am->etapa = ETAPA_SOLICITAR;
+                break;
+
+            case ETAPA_FALHA:
+                falhar(am);
+                return;
+        }
+    }
+}
+
+// --------------------------- TRABALHADORAS ---------------------------
+static void disparar(const temporizador_t* t) {
+    aviao_maquina_t* am = t->alvo;
+    unsigned long aguardando = (t->marca << 2) | ESPERA_AGUARDANDO;
+
+    switch (t->tipo) {
+        case TEMPO_ETAPA:
+            tornar_pronto(am);
+            break;
+
+        case TEMPO_BONUS:
+            // fila_aplicar_bonus ignora o no se ele ja saiu da fila.
+            if (atomic_load(&am->espera) != aguardando) break;
+            if (config.aquisicao == AQUISICAO_CONJUNTO) {
+                conjunto_aplicar_bonus(&am->aviao);
+            } else {
+                fila_aplicar_bonus(fila_do_recurso(am->recurso_aguardado), &am->aviao, am->recurso_aguardado);
+            }
+            break;
+
+        case TEMPO_ALERTA:
+            if (atomic_load(&am->espera) != aguardando) break;
+            pthread_mutex_lock(&mutex_lista_avioes);
+            bool novo_alerta = !am->aviao.em_alerta && atomic_load(&am->espera) == aguardando;
+            am->aviao.em_alerta = true;
+            pthread_mutex_unlock(&mutex_lista_avioes);
+            if (novo_alerta) {
+                log_evento(LOG_ALERTA, NIVEL_AVISO, "[ALERTA] Aviao [%03d] em situacao critica esperando por %s (tempo: %lds).\n",
+                       am->aviao.ID, nome_aguardado(am), (long)(relogio_agora() - am->inicio_espera));
+                rastrear(RASTRO_ALERTA, &am->aviao, recurso_aguardado_rastro(am),
+                         (int)(relogio_agora() - am->inicio_espera));
+            }
+            break;
+
+        case TEMPO_FALHA:
+            if (atomic_compare_exchange_strong(&am->espera, &aguardando, (t->marca << 2) | ESPERA_EXPIRADA)) {
+                am->etapa = ETAPA_FALHA;
+                tornar_pronto(am);
+            }
+            break;
+    }
+}
+
+// Prazos vencidos, fila de injecao e, por fim, roubo de outra trabalhadora.
+static aviao_maquina_t* buscar_trabalho(int indice, unsigned int* semente) {
+    temporizador_t vencidos[32];
+    int num_vencidos = 0;
+    double agora = relogio_real();
+
+    pthread_mutex_lock(&mutex_pool);
+    while (num_vencidos < 32 && agenda_retirar_vencido(&agenda, agora, &vencidos[num_vencidos])) {
+        num_vencidos++;
+    }
+    aviao_maquina_t* am = injecao_inicio;
+    if (am) {
+        injecao_inicio = am->proximo_injetado;
+        if (injecao_inicio == NULL) injecao_fim = NULL;
+    }
+    pthread_mutex_unlock(&mutex_pool);
+
+    for (int i = 0; i < num_vencidos; i++) {
+        disparar(&vencidos[i]);
+    }
+    if (am) return am;
+
+    am = deque_tomar(&deques[indice]);
+    if (am) return am;
+
+    for (int tentativa = 0; tentativa < 2 * num_trabalhadoras; tentativa++) {
+        int vitima = rand_r(semente) % num_trabalhadoras;
+        if (vitima == indice) continue;
+        am = deque_roubar(&deques[vitima]);
+        if (am == ROUBO_ABORTADO) continue;
+        if (am) {
+            atomic_fetch_add(&roubos, 1);
+            return am;
+        }
+    }
+    return NULL;
+}
+
+static void* rotina_trabalhadora(void* arg) {
+    int indice = (int)(intptr_t)arg;
+    unsigned int semente = (unsigned int)indice + 1;
+    indice_trabalhadora = indice;
+
+    while (1) {
+        aviao_maquina_t* am = deque_tomar(&deques[indice]);
+        if (am == NULL) {
+            am = buscar_trabalho(indice, &semente);
+        }
+        if (am != NULL) {
+            avancar(am);
+            atomic_fetch_add_explicit(&etapas_executadas, 1, memory_order_relaxed);
+            continue;
+        }
+
+        pthread_mutex_lock(&mutex_pool);
+        if (encerrando) {
+            pthread_mutex_unlock(&mutex_pool);
+            break;
+        }
+        if (injecao_inicio == NULL) {
+            double limite = relogio_real() + 0.05;
+            double proximo;
+            if (agenda_proximo_prazo(&agenda, &proximo) && proximo < limite) {
+                limite = proximo;
+            }
+            struct timespec ts;
+            ts.tv_sec = (time_t)limite;
+            ts.tv_nsec = (long)((limite - ts.tv_sec) * 1e9);
+            ociosas++;
+            pthread_cond_timedwait(&cond_pool, &mutex_pool, &ts);
+            ociosas--;
+        }
+        pthread_mutex_unlock(&mutex_pool);
+    }
+    return NULL;
+}
+
+// ------------------------------ INTERFACE ------------------------------
+void maquina_iniciar(int trabalhadores) {
+    relogio_iniciar_cond(&cond_pool);
+    pthread_cond_init(&cond_fim, NULL);
+    encerrando = false;
+    avioes_ativos = 0;
+    registro_iniciar(sizeof(aviao_maquina_t));
+    definir_tratador_concessao(repasse_concedido);
+    definir_tratador_preempcao(preempcao_pedida);
+
+    num_trabalhadoras = trabalhadores > 0 ? trabalhadores : 1;
+    deques = malloc(num_trabalhadoras * sizeof(deque_t));
+    trabalhadoras = malloc(num_trabalhadoras * sizeof(pthread_t));
+    if (deques == NULL || trabalhadoras == NULL) {
+        perror("Falha ao alocar trabalhadoras");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < num_trabalhadoras; i++) {
+        deque_iniciar(&deques[i]);
+    }
+    for (int i = 0; i < num_trabalhadoras; i++) {
+        pthread_create(&trabalhadoras[i], NULL, rotina_trabalhadora, (void*)(intptr_t)i);
+    }
+}
+
+void maquina_lancar_aviao(aviao_t* aviao) {
+    aviao_maquina_t* am = (aviao_maquina_t*)aviao;
+    am->operacao = OP_POUSO;
+    am->etapa = ETAPA_INICIAR_OPERACAO;
+    // Registro reaproveitado mantem o ticket: prazos do aviao anterior que
+    // ainda estejam na agenda nao reconhecem as esperas deste.
+    atomic_store(&am->espera, atomic_load(&am->espera) & ~3UL);
+
+    pthread_mutex_lock(&mutex_pool);
+    avioes_ativos++;
+    pthread_mutex_unlock(&mutex_pool);
+    injetar(am);
+}
+
+void maquina_aguardar() {
+    pthread_mutex_lock(&mutex_pool);
+    while (avioes_ativos > 0) {
+        pthread_cond_wait(&cond_fim, &mutex_pool);
+    }
+    encerrando = true;
+    pthread_cond_broadcast(&cond_pool);
+    pthread_mutex_unlock(&mutex_pool);
+
+    for (int i = 0; i < num_trabalhadoras; i++) {
+        pthread_join(trabalhadoras[i], NULL);
+    }
+    for (int i = 0; i < num_trabalhadoras; i++) {
+        deque_destruir(&deques[i]);
+    }
+    free(deques);
+    free(trabalhadoras);
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Maquinas de estado: %lu etapas em %d trabalhadoras, %lu roubos de trabalho.\n",
+           atomic_load(&etapas_executadas), num_trabalhadoras, atomic_load(&roubos));
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Temporizadores das maquinas: %lu agendados, %lu disparados.\n",
+           agenda.inseridos, agenda.disparados);
+    agenda_destruir(&agenda);
+}
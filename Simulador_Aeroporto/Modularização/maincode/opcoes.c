@@ -0,0 +1,282 @@
+#include "aeroporto.h"
+
+static const char* CHAVES_CLASSE[NUM_CLASSES_VOO] = {
+    "domestico", "internacional", "emergencia", "medico", "carga", "geral"
+};
+
+static const char* CHAVES_RECURSO[3] = { "pista", "portao", "torre" };
+
+// --classe=nome:prioridade[:taxa[:peso]], por exemplo --classe=emergencia:55:0.2:1.
+int ler_classe_voo(const char* especificacao) {
+    const char* separador = strchr(especificacao, ':');
+    if (separador == NULL) return -1;
+
+    size_t tamanho = (size_t)(separador - especificacao);
+    int classe = -1;
+    for (int i = 0; i < NUM_CLASSES_VOO; i++) {
+        if (strlen(CHAVES_CLASSE[i]) == tamanho && strncmp(especificacao, CHAVES_CLASSE[i], tamanho) == 0) {
+            classe = i;
+        }
+    }
+    if (classe == -1) return -1;
+
+    // Campos vazios mantem o valor atual: --classe=medico:45::1.
+    char* fim;
+    int prioridade = (int)strtol(separador + 1, &fim, 10);
+    if (fim == separador + 1 || prioridade < 0 || prioridade >= NUM_BALDES) return -1;
+
+    double taxa = classes_voo[classe].taxa_envelhecimento;
+    int peso = classes_voo[classe].peso;
+    if (*fim == ':') {
+        const char* campo = fim + 1;
+        if (*campo != ':' && *campo != '\0') {
+            taxa = strtod(campo, &fim);
+            if (fim == campo || taxa < 0) return -1;
+        } else {
+            fim = (char*)campo;
+        }
+        if (*fim == ':') {
+            campo = fim + 1;
+            peso = (int)strtol(campo, &fim, 10);
+            if (fim == campo || peso < 0) return -1;
+        }
+    }
+    if (*fim != '\0') return -1;
+
+    classes_voo[classe].prioridade_base = prioridade;
+    classes_voo[classe].taxa_envelhecimento = taxa;
+    classes_voo[classe].peso = peso;
+    return 0;
+}
+
+// --ordem=torre,portao,pista: os tres recursos, cada um uma vez, do primeiro
+// a ser pedido ao ultimo.
+static int ler_ordem_global(const char* especificacao) {
+    tipo_recurso ordem[3];
+    bool usado[3] = { false, false, false };
+    const char* campo = especificacao;
+
+    for (int i = 0; i < 3; i++) {
+        size_t tamanho = strcspn(campo, ",");
+        int recurso = -1;
+        for (int r = 0; r < 3; r++) {
+            const char* nome = CHAVES_RECURSO[r];
+            if (strlen(nome) == tamanho && strncmp(campo, nome, tamanho) == 0) recurso = r;
+        }
+        if (recurso == -1 || usado[recurso]) return -1;
+        usado[recurso] = true;
+        ordem[i] = (tipo_recurso)recurso;
+
+        campo += tamanho;
+        if (i < 2) {
+            if (*campo != ',') return -1;
+            campo++;
+        }
+    }
+    if (*campo != '\0') return -1;
+
+    memcpy(config.ordem_global, ordem, sizeof(ordem));
+    return 0;
+}
+
+// Cada nivel dos baldes e um FIFO, exato so se todos nele envelhecem na mesma
+// taxa: recusa classes com a mesma prioridade base e taxas diferentes,
+// contando os domesticos realocados, que entram com PRIORIDADE_REALOCADO.
+static int conferir_niveis_dos_baldes() {
+    for (int i = 0; i < NUM_CLASSES_VOO; i++) {
+        if (classes_voo[i].peso == 0) continue;
+        double taxa = taxa_da_classe((tipo_de_voo)i);
+        for (int j = i; j < NUM_CLASSES_VOO; j++) {
+            if (classes_voo[j].peso == 0) continue;
+            bool mesma_base = j > i && classes_voo[j].prioridade_base == classes_voo[i].prioridade_base;
+            bool realocados = i == DOMESTICO && classes_voo[j].prioridade_base == PRIORIDADE_REALOCADO;
+            if ((mesma_base || realocados) && taxa_da_classe((tipo_de_voo)j) != taxa) {
+                fprintf(stderr, "Classes %s%s e %s dividem um nivel dos baldes com taxas diferentes.\n",
+                        classes_voo[i].nome, realocados ? " (realocados)" : "", classes_voo[j].nome);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+// Opcoes no formato --chave=valor, aceitas depois dos parametros posicionais.
+int ler_opcoes(int argc, char* argv[], int inicio) {
+    config.semente = (unsigned int)time(NULL);
+    config.trabalhadores = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    bool fila_explicita = false;
+
+    for (int i = inicio; i < argc; i++) {
+        const char* opcao = argv[i];
+
+        if (strcmp(opcao, "--motor=threads") == 0) {
+            config.motor = MOTOR_THREADS;
+        } else if (strcmp(opcao, "--motor=eventos") == 0) {
+            config.motor = MOTOR_EVENTOS;
+        } else if (strcmp(opcao, "--motor=fibras") == 0) {
+            config.motor = MOTOR_FIBRAS;
+        } else if (strcmp(opcao, "--motor=maquina") == 0) {
+            config.motor = MOTOR_MAQUINA;
+        } else if (strcmp(opcao, "--fila=lista") == 0) {
+            config.fila = FILA_LISTA;
+            fila_explicita = true;
+        } else if (strcmp(opcao, "--fila=heap") == 0) {
+            config.fila = FILA_HEAP;
+            fila_explicita = true;
+        } else if (strcmp(opcao, "--fila=baldes") == 0) {
+            config.fila = FILA_BALDES;
+            fila_explicita = true;
+        } else if (strcmp(opcao, "--fila=skiplist") == 0) {
+            config.fila = FILA_SKIPLIST;
+            fila_explicita = true;
+        } else if (strcmp(opcao, "--aquisicao=passos") == 0) {
+#ifdef ORDEM_GLOBAL
+            fprintf(stderr, "Aquisicao por passos indisponivel: compilado com ORDEM_GLOBAL, sem detector.\n");
+            return -1;
+#else
+            config.aquisicao = AQUISICAO_PASSOS;
+#endif
+        } else if (strcmp(opcao, "--aquisicao=conjunto") == 0) {
+            config.aquisicao = AQUISICAO_CONJUNTO;
+        } else if (strcmp(opcao, "--aquisicao=ordenada") == 0) {
+            config.aquisicao = AQUISICAO_ORDENADA;
+        } else if (strcmp(opcao, "--aquisicao=banqueiro") == 0) {
+            config.aquisicao = AQUISICAO_BANQUEIRO;
+        } else if (strncmp(opcao, "--ordem=", 8) == 0) {
+            if (ler_ordem_global(opcao + 8) == -1) {
+                fprintf(stderr, "Ordem de recursos invalida: %s\n", opcao + 8);
+                return -1;
+            }
+        } else if (strncmp(opcao, "--classe=", 9) == 0) {
+            if (ler_classe_voo(opcao + 9) == -1) {
+                fprintf(stderr, "Classe de voo invalida: %s\n", opcao + 9);
+                return -1;
+            }
+        } else if (strcmp(opcao, "--envelhecimento=degraus") == 0) {
+            config.envelhecimento = ENVELHECIMENTO_DEGRAUS;
+        } else if (strncmp(opcao, "--envelhecimento=", 17) == 0) {
+            config.envelhecimento = ENVELHECIMENTO_LINEAR;
+            config.taxa_envelhecimento = atof(opcao + 17);
+            if (config.taxa_envelhecimento < 0) {
+                fprintf(stderr, "Taxa de envelhecimento invalida: %s\n", opcao + 17);
+                return -1;
+            }
+        } else if (strncmp(opcao, "--carencia=", 11) == 0) {
+            config.carencia = atoi(opcao + 11);
+            if (config.carencia < 0) {
+                fprintf(stderr, "Carencia invalida: %s\n", opcao + 11);
+                return -1;
+            }
+        } else if (strncmp(opcao, "--bonus-espera=", 15) == 0) {
+            config.bonus_espera = atoi(opcao + 15);
+        } else if (strncmp(opcao, "--limiar-bonus=", 15) == 0) {
+            config.limiar_bonus = atoi(opcao + 15);
+            if (config.limiar_bonus < 0) {
+                fprintf(stderr, "Limiar de bonus invalido: %s\n", opcao + 15);
+                return -1;
+            }
+        } else if (strncmp(opcao, "--trabalhadores=", 16) == 0) {
+            config.trabalhadores = atoi(opcao + 16);
+        } else if (strncmp(opcao, "--pilha-fibra=", 14) == 0) {
+            config.pilha_fibra = (size_t)atoi(opcao + 14) * 1024;
+            if (config.pilha_fibra < 16 * 1024) {
+                fprintf(stderr, "Pilha de fibra muito pequena (minimo 16 KB).\n");
+                return -1;
+            }
+        } else if (strncmp(opcao, "--semente=", 10) == 0) {
+            config.semente = (unsigned int)strtoul(opcao + 10, NULL, 10);
+        } else if (strncmp(opcao, "--escala=", 9) == 0) {
+            config.escala_tempo = atof(opcao + 9);
+            if (config.escala_tempo <= 0) {
+                fprintf(stderr, "Escala de tempo invalida: %s\n", opcao + 9);
+                return -1;
+            }
+        } else if (strncmp(opcao, "--max-avioes=", 13) == 0) {
+            config.max_avioes = atoi(opcao + 13);
+            if (config.max_avioes < 0) {
+                fprintf(stderr, "Limite de avioes invalido: %s\n", opcao + 13);
+                return -1;
+            }
+        } else if (strncmp(opcao, "--fator-chegadas=", 17) == 0) {
+            config.fator_chegadas = atof(opcao + 17);
+            if (config.fator_chegadas <= 0) {
+                fprintf(stderr, "Fator de chegadas invalido: %s\n", opcao + 17);
+                return -1;
+            }
+        } else if (strncmp(opcao, "--log-capacidade=", 17) == 0) {
+            long capacidade = atol(opcao + 17);
+            if (capacidade < 2) {
+                fprintf(stderr, "Capacidade do log invalida: %s\n", opcao + 17);
+                return -1;
+            }
+            config.log_capacidade = (size_t)capacidade;
+        } else if (strncmp(opcao, "--log-nivel=", 12) == 0) {
+            if (log_definir_nivel(opcao + 12) == -1) {
+                fprintf(stderr, "Nivel de log invalido: %s\n", opcao + 12);
+                return -1;
+            }
+        } else if (strncmp(opcao, "--log-limite=", 13) == 0) {
+            if (log_definir_limite(opcao + 13, false) == -1) {
+                fprintf(stderr, "Limite de log invalido: %s\n", opcao + 13);
+                return -1;
+            }
+        } else if (strncmp(opcao, "--log-amostra=", 14) == 0) {
+            if (log_definir_limite(opcao + 14, true) == -1) {
+                fprintf(stderr, "Amostra de log invalida: %s\n", opcao + 14);
+                return -1;
+            }
+        } else if (strncmp(opcao, "--log-saida=", 12) == 0) {
+            config.log_saidas = log_ler_saidas(opcao + 12);
+            if (config.log_saidas == -1) {
+                fprintf(stderr, "Saidas de log invalidas: %s\n", opcao + 12);
+                return -1;
+            }
+        } else if (strcmp(opcao, "--log-binario") == 0) {
+            config.log_binario = true;
+        } else if (strcmp(opcao, "--rastro") == 0) {
+            config.rastro = true;
+        } else if (strcmp(opcao, "--log-cheio=bloquear") == 0) {
+            config.log_cheio = LOG_CHEIO_BLOQUEAR;
+        } else if (strcmp(opcao, "--log-cheio=descartar") == 0) {
+            config.log_cheio = LOG_CHEIO_DESCARTAR;
+        } else if (strcmp(opcao, "--log-cheio=sobrescrever") == 0) {
+            config.log_cheio = LOG_CHEIO_SOBRESCREVER;
+        } else {
+            fprintf(stderr, "Opcao desconhecida: %s\n", opcao);
+            return -1;
+        }
+    }
+
+    // O log binario existe para nao formatar nada: por padrao, sem console.
+    if (config.log_saidas == -1) {
+        config.log_saidas = config.log_binario ? SAIDA_LOG_ARQUIVO : SAIDAS_LOG_PADRAO;
+    }
+
+    // O banqueiro percorre as filas em ordem para pular pedidos inseguros:
+    // usa a lista, e so recusa outra fila pedida explicitamente.
+    if (config.aquisicao == AQUISICAO_BANQUEIRO) {
+        if (fila_explicita && config.fila != FILA_LISTA) {
+            fprintf(stderr, "A aquisicao pelo banqueiro percorre a fila em ordem: use --fila=lista.\n");
+            return -1;
+        }
+        config.fila = FILA_LISTA;
+    }
+
+    if (config.fila == FILA_BALDES && config.envelhecimento == ENVELHECIMENTO_LINEAR &&
+        conferir_niveis_dos_baldes() == -1) {
+        return -1;
+    }
+
+    if (config.fila == FILA_SKIPLIST && config.envelhecimento == ENVELHECIMENTO_DEGRAUS) {
+        fprintf(stderr, "A fila skiplist nao se reordena a cada segundo: use --envelhecimento=X (linear).\n");
+        return -1;
+    }
+
+    int peso_total = 0;
+    for (int i = 0; i < NUM_CLASSES_VOO; i++) peso_total += classes_voo[i].peso;
+    if (peso_total == 0) {
+        fprintf(stderr, "Nenhuma classe de voo com peso positivo.\n");
+        return -1;
+    }
+    return 0;
+}
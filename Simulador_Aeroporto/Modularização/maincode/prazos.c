@@ -0,0 +1,86 @@
+#include "aeroporto.h"
+
+// ------------------------- PRAZOS DE ESPERA -------------------------
+// Prazos de bonus, alerta e falha dos avioes que esperam por recurso nos
+// motores de threads e de fibras. Uma unica thread dorme ate o proximo prazo
+// da roda e acorda so o aviao daquele prazo; quem espera dorme no proprio no
+// sem prazo nenhum. A marca e a ordem do no na fila: se ele ja foi atendido
+// ou entrou em outra espera, o disparo e descartado.
+
+static agenda_t agenda_prazos;
+static pthread_mutex_t mutex_prazos = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_prazos;
+static pthread_t thread_prazos;
+static bool prazos_ativos = false;
+static unsigned long prazos_descartados = 0;
+
+static void disparar_prazo(const temporizador_t* t) {
+    request_node_t* no = t->alvo;
+    fila_prioridade_t* fila = fila_do_no(no);
+
+    pthread_mutex_lock(&fila->mutex);
+    if (no->na_fila && no->ordem == t->marca) {
+        no->prazos_disparados++;
+        espera_sinalizar(&no->espera);
+    } else {
+        prazos_descartados++;
+    }
+    pthread_mutex_unlock(&fila->mutex);
+}
+
+static void* rotina_prazos(void* arg) {
+    (void)arg;
+    pthread_mutex_lock(&mutex_prazos);
+    while (prazos_ativos) {
+        temporizador_t t;
+        while (agenda_retirar_vencido(&agenda_prazos, relogio_real(), &t)) {
+            pthread_mutex_unlock(&mutex_prazos);
+            disparar_prazo(&t);
+            pthread_mutex_lock(&mutex_prazos);
+        }
+
+        double limite = relogio_real() + 1.0;
+        double proximo;
+        if (agenda_proximo_prazo(&agenda_prazos, &proximo) && proximo < limite) {
+            limite = proximo;
+        }
+        struct timespec ts;
+        ts.tv_sec = (time_t)limite;
+        ts.tv_nsec = (long)((limite - ts.tv_sec) * 1e9);
+        pthread_cond_timedwait(&cond_prazos, &mutex_prazos, &ts);
+    }
+    pthread_mutex_unlock(&mutex_prazos);
+    return NULL;
+}
+
+void prazos_iniciar() {
+    relogio_iniciar_cond(&cond_prazos);
+    prazos_ativos = true;
+    pthread_create(&thread_prazos, NULL, rotina_prazos, NULL);
+}
+
+// Chamada com o mutex da fila do no travado, logo depois de ele entrar nela.
+void prazos_agendar(request_node_t* no, double segundos) {
+    struct timespec ts;
+    relogio_prazo(segundos, &ts);
+
+    pthread_mutex_lock(&mutex_prazos);
+    if (agenda_inserir(&agenda_prazos, ts.tv_sec + ts.tv_nsec / 1e9, no, no->ordem, 0)) {
+        pthread_cond_signal(&cond_prazos);
+    }
+    pthread_mutex_unlock(&mutex_prazos);
+}
+
+void prazos_encerrar() {
+    pthread_mutex_lock(&mutex_prazos);
+    prazos_ativos = false;
+    pthread_cond_signal(&cond_prazos);
+    pthread_mutex_unlock(&mutex_prazos);
+    pthread_join(thread_prazos, NULL);
+
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Prazos de espera: %lu agendados, %lu disparados, %lu descartados, %zu pendentes no fim.\n",
+           agenda_prazos.inseridos, agenda_prazos.disparados - prazos_descartados, prazos_descartados,
+           agenda_prazos.pendentes);
+    agenda_destruir(&agenda_prazos);
+    pthread_cond_destroy(&cond_prazos);
+}
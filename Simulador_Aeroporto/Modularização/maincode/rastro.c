@@ -0,0 +1,184 @@
+#include "rastro.h"
+#include "logger.h"
+#include "relogio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+// ------------------------- RASTRO -------------------------
+// Quem registra codifica o evento direto no segmento mapeado, sob um mutex
+// curto: o tempo e lido com ele travado, entao os deltas de um segmento quase
+// sempre sao pequenos e positivos. Trocar de segmento custa um ftruncate e um
+// mmap a cada TAMANHO_SEGMENTO_RASTRO bytes; nada espera pelo disco.
+
+#define INICIO_EVENTOS  sizeof(cabecalho_segmento_rastro_t)
+
+bool rastro_ativo = false;
+
+const char* NOMES_EVENTOS_RASTRO[NUM_TIPOS_RASTRO] = {
+    "pedido", "concessao", "liberacao", "alerta", "falha", "impasse", "verificacao", "realocacao"
+};
+
+static pthread_mutex_t mutex_rastro = PTHREAD_MUTEX_INITIALIZER;
+static int descritor = -1;
+static unsigned char* segmento = NULL;
+static cabecalho_segmento_rastro_t* cabecalho = NULL;
+static size_t usado;                // bytes do segmento atual, com o cabecalho
+static int64_t tempo_anterior;
+static unsigned long num_segmentos = 0;
+static unsigned long eventos = 0;
+static unsigned long bytes_eventos = 0;
+static unsigned long eventos_por_tipo[NUM_TIPOS_RASTRO];
+
+static size_t escrever_varint(unsigned char* p, uint64_t valor) {
+    size_t n = 0;
+    while (valor >= 0x80) {
+        p[n++] = (unsigned char)(valor | 0x80);
+        valor >>= 7;
+    }
+    p[n++] = (unsigned char)valor;
+    return n;
+}
+
+static uint64_t zigzag(int64_t valor) {
+    return ((uint64_t)valor << 1) ^ (uint64_t)(valor >> 63);
+}
+
+static void fechar_segmento() {
+    if (segmento == NULL) return;
+    munmap(segmento, TAMANHO_SEGMENTO_RASTRO);
+    segmento = NULL;
+    cabecalho = NULL;
+}
+
+static void abrir_segmento(int64_t tempo) {
+    fechar_segmento();
+    off_t inicio = (off_t)num_segmentos * TAMANHO_SEGMENTO_RASTRO;
+    if (ftruncate(descritor, inicio + TAMANHO_SEGMENTO_RASTRO) == -1) {
+        perror("Falha ao expandir o rastro");
+        exit(EXIT_FAILURE);
+    }
+    segmento = mmap(NULL, TAMANHO_SEGMENTO_RASTRO, PROT_READ | PROT_WRITE, MAP_SHARED, descritor, inicio);
+    if (segmento == MAP_FAILED) {
+        perror("Falha ao mapear o segmento do rastro");
+        exit(EXIT_FAILURE);
+    }
+    num_segmentos++;
+
+    cabecalho = (cabecalho_segmento_rastro_t*)segmento;
+    memcpy(cabecalho->magico, MAGICO_RASTRO, sizeof(cabecalho->magico));
+    cabecalho->eventos = 0;
+    cabecalho->bytes = 0;
+    cabecalho->tempo_base_ns = tempo;
+    tempo_anterior = tempo;
+    usado = INICIO_EVENTOS;
+}
+
+void rastro_iniciar(const char* caminho) {
+    descritor = open(caminho, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (descritor == -1) {
+        perror("Falha ao abrir o arquivo de rastro");
+        exit(EXIT_FAILURE);
+    }
+    num_segmentos = 0;
+    eventos = 0;
+    bytes_eventos = 0;
+    memset(eventos_por_tipo, 0, sizeof(eventos_por_tipo));
+    abrir_segmento(0);
+    rastro_ativo = true;
+}
+
+void rastro_registrar(tipo_evento_rastro tipo, int aviao, int recurso, int prioridade, int valor) {
+    pthread_mutex_lock(&mutex_rastro);
+    if (segmento == NULL) {
+        pthread_mutex_unlock(&mutex_rastro);
+        return;
+    }
+    int64_t tempo = (int64_t)(relogio_agora() * 1e9);
+    if (usado + MAX_EVENTO_RASTRO > TAMANHO_SEGMENTO_RASTRO) abrir_segmento(tempo);
+
+    unsigned char* p = segmento + usado;
+    size_t n = 0;
+    p[n++] = (unsigned char)(tipo | recurso << 4);
+    n += escrever_varint(p + n, zigzag(tempo - tempo_anterior));
+    n += escrever_varint(p + n, (uint32_t)aviao);
+    n += escrever_varint(p + n, zigzag(prioridade));
+    n += escrever_varint(p + n, zigzag(valor));
+    tempo_anterior = tempo;
+
+    usado += n;
+    cabecalho->eventos++;
+    cabecalho->bytes = (uint32_t)(usado - INICIO_EVENTOS);
+    eventos++;
+    bytes_eventos += n;
+    eventos_por_tipo[tipo]++;
+    pthread_mutex_unlock(&mutex_rastro);
+}
+
+// Corta o arquivo no fim dos dados do ultimo segmento.
+void rastro_encerrar() {
+    if (!rastro_ativo) return;
+    pthread_mutex_lock(&mutex_rastro);
+    rastro_ativo = false;
+    off_t tamanho = (off_t)(num_segmentos - 1) * TAMANHO_SEGMENTO_RASTRO + usado;
+    fechar_segmento();
+    if (ftruncate(descritor, tamanho) == -1) perror("Falha ao cortar o rastro");
+    close(descritor);
+    descritor = -1;
+    pthread_mutex_unlock(&mutex_rastro);
+
+    char por_tipo[256];
+    int escrito = 0;
+    for (int i = 0; i < NUM_TIPOS_RASTRO; i++) {
+        escrito += snprintf(por_tipo + escrito, sizeof(por_tipo) - escrito, "%s%s %lu", i ? ", " : "",
+                            NOMES_EVENTOS_RASTRO[i], eventos_por_tipo[i]);
+    }
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Rastro: %lu eventos em %lu segmentos, %.1f bytes por evento (%s).\n",
+               eventos, num_segmentos, eventos ? (double)bytes_eventos / eventos : 0.0, por_tipo);
+}
+
+// ------------------------- LEITURA -------------------------
+
+static size_t ler_varint(const unsigned char* p, size_t tamanho, uint64_t* valor) {
+    uint64_t resultado = 0;
+    for (size_t n = 0; n < tamanho && n < 10; n++) {
+        resultado |= (uint64_t)(p[n] & 0x7f) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *valor = resultado;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static int64_t desfazer_zigzag(uint64_t valor) {
+    return (int64_t)(valor >> 1) ^ -(int64_t)(valor & 1);
+}
+
+// Decodifica o evento no comeco de "dados", atualizando "tempo_anterior"
+// (comeca em tempo_base_ns do segmento). Devolve os bytes lidos, 0 se o
+// evento esta incompleto ou corrompido.
+size_t rastro_decodificar(const unsigned char* dados, size_t tamanho, int64_t* tempo_anterior,
+                          evento_rastro_t* evento) {
+    if (tamanho == 0 || (dados[0] & 0x0f) >= NUM_TIPOS_RASTRO) return 0;
+    evento->tipo = dados[0] & 0x0f;
+    evento->recurso = dados[0] >> 4;
+
+    uint64_t campos[4];
+    size_t lidos = 1;
+    for (int i = 0; i < 4; i++) {
+        size_t n = ler_varint(dados + lidos, tamanho - lidos, &campos[i]);
+        if (n == 0) return 0;
+        lidos += n;
+    }
+    *tempo_anterior += desfazer_zigzag(campos[0]);
+    evento->tempo_ns = *tempo_anterior;
+    evento->aviao = (int32_t)campos[1];
+    evento->prioridade = (int32_t)desfazer_zigzag(campos[2]);
+    evento->valor = (int32_t)desfazer_zigzag(campos[3]);
+    return lidos;
+}
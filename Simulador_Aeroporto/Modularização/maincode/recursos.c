@@ -1,46 +1,311 @@
 #include "aeroporto.h"
 
-int solicitar_recurso_com_prioridade(fila_prioridade_t* fila, sem_t* sem_recurso, aviao_t* aviao, tipo_recurso tipo, const char* nome_recurso) {
-    log_message("[RECURSO] Aviao [%03d] solicitou %s.\n", aviao->ID, nome_recurso);
-    
-    if (aviao->recursos_realocados && aviao->tipo == DOMESTICO) {
-        log_message("[SISTEMA] Aviao [%03d] (domestico realocado) tem prioridade maxima.\n", aviao->ID);
+// Ordem de aquisicao de cada operacao por rota: [operacao][rota][passo]. A rota
+// de cada classe de voo vem de classes_voo (DOMESTICO ou INTERNACIONAL).
+// Todos os motores seguem esta tabela. As duas rotas pedem os recursos em
+// ordens opostas, o que permite espera circular; com --aquisicao=ordenada
+// definir_ordem_global reescreve as linhas na partida.
+tipo_recurso ORDEM_RECURSOS[3][2][3] = {
+    { { RECURSO_TORRE, RECURSO_PISTA },                  { RECURSO_PISTA, RECURSO_TORRE } },
+    { { RECURSO_TORRE, RECURSO_PORTAO },                 { RECURSO_PORTAO, RECURSO_TORRE } },
+    { { RECURSO_TORRE, RECURSO_PORTAO, RECURSO_PISTA },  { RECURSO_PORTAO, RECURSO_PISTA, RECURSO_TORRE } }
+};
+const int NUM_PASSOS_OPERACAO[3] = { 2, 2, 3 };
+
+// Uma so ordem para todas as operacoes e rotas: quem espera por um recurso
+// so segura recursos anteriores a ele, entao nao ha ciclo de espera.
+void definir_ordem_global(const tipo_recurso ordem[3]) {
+    int posicao[3];
+    for (int i = 0; i < 3; i++) posicao[ordem[i]] = i;
+
+    for (int op = 0; op < 3; op++) {
+        for (int rota = 0; rota < 2; rota++) {
+            tipo_recurso* passos = ORDEM_RECURSOS[op][rota];
+            for (int i = 1; i < NUM_PASSOS_OPERACAO[op]; i++) {
+                tipo_recurso recurso = passos[i];
+                int j = i;
+                for (; j > 0 && posicao[passos[j - 1]] > posicao[recurso]; j--) {
+                    passos[j] = passos[j - 1];
+                }
+                passos[j] = recurso;
+            }
+        }
     }
-    
-    if (adicionar_requisicao(fila, aviao, tipo) == -1) {
-        return -1;
+}
+// Os mesmos recursos como conjunto, um bit por tipo_recurso (--aquisicao=conjunto).
+const int CONJUNTO_OPERACAO[3] = {
+    (1 << RECURSO_PISTA) | (1 << RECURSO_TORRE),
+    (1 << RECURSO_PORTAO) | (1 << RECURSO_TORRE),
+    (1 << RECURSO_PORTAO) | (1 << RECURSO_PISTA) | (1 << RECURSO_TORRE)
+};
+const int DURACAO_OPERACAO[3] = { 2, 3, 2 };
+const char* NOME_OPERACAO[3] = { "pouso", "desembarque", "decolagem" };
+const char* RECURSOS_OPERACAO[3] = {
+    "POUSO (Pista + Torre)", "DESEMBARQUE (Portao + Torre)", "DECOLAGEM (Portao + Pista + Torre)"
+};
+const char* MENSAGEM_ANDAMENTO[3] = {
+    "[AVIAO %03d] Pouso em andamento (duracao: 2s).\n",
+    "[AVIAO %03d] Desembarque de passageiros em andamento (duracao: 3s).\n",
+    "[AVIAO %03d] Decolagem em andamento (duracao: 2s).\n"
+};
+
+fila_prioridade_t* fila_do_recurso(tipo_recurso recurso) {
+    if (recurso == RECURSO_PISTA) return &fila_pistas;
+    if (recurso == RECURSO_PORTAO) return &fila_portoes;
+    return &fila_torre_ops;
+}
+
+fila_prioridade_t* fila_do_no(const request_node_t* no) {
+    if (no->recursos != 0) return &conjuntos.fila;
+    return fila_do_recurso(no->recurso_desejado);
+}
+
+recurso_t* recurso_do_tipo(tipo_recurso recurso) {
+    if (recurso == RECURSO_PISTA) return &recurso_pistas;
+    if (recurso == RECURSO_PORTAO) return &recurso_portoes;
+    return &recurso_torre_ops;
+}
+
+const char* nome_do_recurso(tipo_recurso recurso) {
+    if (recurso == RECURSO_PISTA) return "PISTA";
+    if (recurso == RECURSO_PORTAO) return "PORTAO";
+    return "TORRE DE CONTROLE";
+}
+
+// ------------------------- RECURSO COM REPASSE -------------------------
+// Unidades livres e fila de espera ficam sob o mesmo mutex (o da fila). Quem
+// libera entrega a unidade direto ao cabeca da fila, que ja sai dela
+// atendido; ninguem precisa disputar a unidade depois de acordar. Invariante:
+// se ha unidade livre, a fila esta vazia. Com --aquisicao=banqueiro a
+// concessao tambem precisa ser segura e quem a decide e banqueiro_reavaliar;
+// ai pode haver unidade livre com pedidos ainda inseguros na fila.
+//
+// Os motores sem uma thread por aviao registram um tratador de concessao,
+// chamado com o mutex da fila travado para que o aviao nao termine (e tenha o
+// registro reaproveitado) entre sair da fila e receber a unidade. Se o
+// tratador recusa, a espera ja tinha expirado e a unidade vai para o proximo.
+// Sem tratador, o aviao e acordado no proprio no. O tratador de preempcao
+// segue a mesma regra para o aviao tirado da fila por recurso_interromper.
+
+static bool (*tratador_concessao)(request_node_t* no) = NULL;
+static bool (*tratador_preempcao)(request_node_t* no) = NULL;
+
+void definir_tratador_concessao(bool (*tratador)(request_node_t* no)) {
+    tratador_concessao = tratador;
+}
+
+void definir_tratador_preempcao(bool (*tratador)(request_node_t* no)) {
+    tratador_preempcao = tratador;
+}
+
+void inicializar_recurso(recurso_t* recurso, tipo_recurso tipo, fila_prioridade_t* fila, int unidades) {
+    recurso->tipo = tipo;
+    recurso->fila = fila;
+    recurso->livres = unidades;
+    recurso->unidades = unidades;
+    recurso->concessoes_imediatas = 0;
+    recurso->repasses = 0;
+    recurso->latencias = 0;
+    recurso->latencia_total = 0;
+}
+
+// Retorna 1 se havia unidade livre (concedida na hora), 0 se o aviao entrou
+// na fila ou -1 se nao foi possivel enfileira-lo.
+int recurso_solicitar(recurso_t* recurso, aviao_t* aviao) {
+    fila_prioridade_t* fila = recurso->fila;
+
+    pthread_mutex_lock(&fila->mutex);
+    if (recurso->livres > 0 &&
+        (config.aquisicao != AQUISICAO_BANQUEIRO || banqueiro_conceder(aviao, recurso->tipo))) {
+        recurso->livres--;
+        recurso->concessoes_imediatas++;
+        pthread_mutex_unlock(&fila->mutex);
+        return 1;
     }
-    
-    registrar_requisicao(aviao, tipo);
-    adicionar_aviao_warning(aviao);
-    
-    time_t tempo_inicio_espera = time(NULL);
-    
-    while (1) {
+    int resultado = adicionar_requisicao_travada(fila, aviao, recurso->tipo);
+    pthread_mutex_unlock(&fila->mutex);
+    return resultado == -1 ? -1 : 0;
+}
+
+// Entrega ao no que acabou de sair da fila o que ele pediu. Chamada com o
+// mutex da fila travado; false se a espera ja tinha expirado.
+bool entregar_ao_no(request_node_t* no) {
+    no->atendido = true;
+    no->concedido_em = relogio_real();
+    if (tratador_concessao == NULL) {
+        espera_sinalizar(&no->espera);
+        return true;
+    }
+    return tratador_concessao(no);
+}
+
+// Devolve uma unidade: vai para o cabeca da fila ou, sem ninguem esperando,
+// volta para as livres. Com pedidos de conjunto as unidades pertencem ao
+// alocador de conjuntos.
+void recurso_devolver(recurso_t* recurso) {
+    if (config.aquisicao == AQUISICAO_CONJUNTO) {
+        conjunto_devolver(1 << recurso->tipo);
+        return;
+    }
+    if (config.aquisicao == AQUISICAO_BANQUEIRO) {
+        pthread_mutex_lock(&recurso->fila->mutex);
+        recurso->livres++;
+        pthread_mutex_unlock(&recurso->fila->mutex);
+        banqueiro_reavaliar();
+        return;
+    }
+
+    fila_prioridade_t* fila = recurso->fila;
+    request_node_t* cabeca;
+
+    pthread_mutex_lock(&fila->mutex);
+    while ((cabeca = fila_cabeca(fila)) != NULL) {
+        // Na skiplist quem desiste por starvation remove sem fila->mutex e
+        // pode ter levado o cabeca primeiro: a unidade vai para o proximo.
+        if (!remover_no_travado(fila, cabeca)) continue;
+        if (entregar_ao_no(cabeca)) break;
+    }
+    if (cabeca != NULL) {
+        recurso->repasses++;
+    } else {
+        recurso->livres++;
+    }
+    pthread_mutex_unlock(&fila->mutex);
+}
+
+// ------------------------- PREEMPCAO -------------------------
+// A vitima de um impasse (escolhida pelo detector) e tirada da fila do
+// recurso que espera e avisada; e ela mesma que devolve, pelo caminho normal
+// de liberacao, o que segura na operacao e volta a pedir desde o primeiro
+// passo. Ninguem devolve por ela uma unidade que ela ainda acredita ter.
+//
+// O que a vitima devolve nessa hora vai para os herdeiros, membros do mesmo
+// impasse que aguardam cada recurso (veja liberar_recurso_com_prioridade);
+// ficam gravados antes do aviso, que a vitima so le depois.
+//
+// false se o aviao nao esta mais esperando: foi atendido, desistiu ou o
+// registro ja pertence a outro aviao (por isso o ID, conferido sob o mutex da
+// fila, que ordena a escrita do ID de um aviao novo antes do seu pedido).
+bool recurso_interromper(aviao_t* aviao, int id, aviao_t* const herdeiros[3], const int ids_herdeiros[3]) {
+    for (int r = 0; r < 3; r++) {
+        request_node_t* no = &aviao->requisicoes[r];
+        fila_prioridade_t* fila = fila_do_recurso((tipo_recurso)r);
+
         pthread_mutex_lock(&fila->mutex);
-        request_node_t* proximo = fila->head;
-        
-        if (proximo != NULL && proximo->aviao->ID == aviao->ID) {
-            pthread_mutex_unlock(&fila->mutex);
-            break;
-        } else {
-            request_node_t* meu_node = fila->head;
-            while (meu_node != NULL && meu_node->aviao->ID != aviao->ID) {
-                meu_node = meu_node->next;
+        bool interrompido = false;
+        if (no->na_fila && atomic_load_explicit(&aviao->ID, memory_order_acquire) == id && remover_no_travado(fila, no)) {
+            no->preemptado = true;
+            for (int h = 0; h < 3; h++) {
+                aviao->ids_herdeiros[h] = ids_herdeiros[h];
+                atomic_store(&aviao->herdeiros[h], herdeiros[h]);
             }
-            
-            if (meu_node != NULL) {
-                struct timespec ts;
-                clock_gettime(CLOCK_REALTIME, &ts);
-                ts.tv_sec += 2;
-                pthread_cond_timedwait(&meu_node->cond_var, &fila->mutex, &ts);
+            if (tratador_preempcao != NULL) {
+                interrompido = tratador_preempcao(no);
+            } else {
+                espera_sinalizar(&no->espera);
+                interrompido = true;
             }
+            if (!interrompido) aviao_esquecer_herdeiros(aviao);
+        }
+        pthread_mutex_unlock(&fila->mutex);
+        if (interrompido) return true;
+    }
+    return false;
+}
+
+void aviao_esquecer_herdeiros(aviao_t* aviao) {
+    for (int h = 0; h < 3; h++) {
+        atomic_store(&aviao->herdeiros[h], NULL);
+    }
+}
+
+// Entrega a unidade devolvida pela vitima ao herdeiro desse recurso, se ele
+// ainda for o mesmo aviao e ainda a aguardar. Cada herdeiro vale uma vez.
+static bool repassar_ao_herdeiro(recurso_t* recurso, aviao_t* aviao) {
+    aviao_t* herdeiro = atomic_exchange(&aviao->herdeiros[recurso->tipo], NULL);
+    if (herdeiro == NULL) return false;
+
+    request_node_t* no = &herdeiro->requisicoes[recurso->tipo];
+    fila_prioridade_t* fila = recurso->fila;
+    pthread_mutex_lock(&fila->mutex);
+    int id = atomic_load_explicit(&herdeiro->ID, memory_order_acquire);
+    bool entregue = id == aviao->ids_herdeiros[recurso->tipo] && no->na_fila &&
+                    remover_no_travado(fila, no) && entregar_ao_no(no);
+    if (entregue) recurso->repasses++;
+    pthread_mutex_unlock(&fila->mutex);
+    return entregue;
+}
+
+// Chamada pela vitima depois de devolver o que segurava na operacao. Os
+// avisos recomecam: se ela voltar a um impasse, pode ser escolhida de novo.
+void aviao_preemptado(aviao_t* aviao, tipo_operacao operacao) {
+    aviao_esquecer_herdeiros(aviao);
+    aviao->recursos_realocados = true;
+    pthread_mutex_lock(&mutex_warnings);
+    aviao->deadlock_warnings = 0;
+    pthread_mutex_unlock(&mutex_warnings);
+    log_evento(LOG_DEADLOCK, NIVEL_INFO, "[DEADLOCK] Aviao [%03d] devolveu os recursos de %s e volta a pedi-los.\n",
+           aviao->ID, NOME_OPERACAO[operacao]);
+}
+
+// A latencia so e medida onde o aviao espera no no: nos outros motores o
+// tratador avanca o aviao no proprio repasse. Unidades livres no fim diferentes
+// do total indicam unidade devolvida duas vezes ou nunca devolvida.
+void recurso_registrar_estatisticas(recurso_t* recurso) {
+    if (recurso->latencias == 0) {
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] %s: %lu concessoes imediatas, %lu repasses diretos, %d de %d unidades livres no fim.\n",
+               nome_do_recurso(recurso->tipo), recurso->concessoes_imediatas, recurso->repasses,
+               recurso->livres, recurso->unidades);
+        return;
+    }
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] %s: %lu concessoes imediatas, %lu repasses diretos, latencia media do repasse %.1f us, "
+           "%d de %d unidades livres no fim.\n",
+           nome_do_recurso(recurso->tipo), recurso->concessoes_imediatas, recurso->repasses,
+           recurso->latencia_total / recurso->latencias * 1e6, recurso->livres, recurso->unidades);
+}
+
+// O aviao espera no proprio no da fila, como thread ou como fibra, e so acorda
+// quando recebe o que pediu, quando a thread de prazos dispara um dos marcos
+// da espera (bonus, alerta ou falha) ou quando e interrompido como vitima de
+// um impasse. Retorna -1 na falha por starvation e -2 na preempcao, com o no
+// ja fora da fila.
+static int aguardar_concessao(fila_prioridade_t* fila, request_node_t* no, const char* nome,
+                              unsigned long* latencias, double* latencia_total) {
+    aviao_t* aviao = no->aviao;
+    double tempo_inicio_espera = no->tempo_chegada;
+    int prazos_vistos = 0;
+    int recurso_rastreado = no->recursos != 0 ? RECURSO_RASTRO_NENHUM : (int)no->recurso_desejado;
+
+    pthread_mutex_lock(&fila->mutex);
+    if (!no->atendido) {
+        double decorrido = relogio_agora() - tempo_inicio_espera;
+        if (config.limiar_bonus < FALHA) prazos_agendar(no, config.limiar_bonus - decorrido);
+        if (ALERTA_CRITICO < FALHA) prazos_agendar(no, ALERTA_CRITICO - decorrido);
+        prazos_agendar(no, FALHA - decorrido);
+    }
+    while (1) {
+        if (no->atendido) {
+            (*latencias)++;
+            *latencia_total += relogio_real() - no->concedido_em;
+            break;
+        }
+        if (no->preemptado) {
             pthread_mutex_unlock(&fila->mutex);
+            return -2;
+        }
+        if (no->prazos_disparados == prazos_vistos) {
+            espera_aguardar(&no->espera, &fila->mutex, NULL);
+            continue;
         }
+        prazos_vistos = no->prazos_disparados;
         
-        time_t tempo_espera_total = time(NULL) - tempo_inicio_espera;
+        long tempo_espera_total = (long)(relogio_agora() - tempo_inicio_espera);
+        bool desistiu = tempo_espera_total >= FALHA &&
+                        (no->recursos != 0 ? conjunto_desistir_travado(no) : remover_no_travado(fila, no));
         
-        if (tempo_espera_total >= FALHA) {
+        if (desistiu) {
+            pthread_mutex_unlock(&fila->mutex);
+            
             pthread_mutex_lock(&mutex_lista_avioes);
             aviao->estado = FALHA_OPERACIONAL;
             pthread_mutex_unlock(&mutex_lista_avioes);
@@ -49,138 +314,185 @@ int solicitar_recurso_com_prioridade(fila_prioridade_t* fila, sem_t* sem_recurso
             contador_starvation++;
             pthread_mutex_unlock(&mutex_contadores);
             
-            remover_requisicao(fila, aviao);
-            limpar_requisicao(aviao, tipo);
-            
-            log_message("[ALERTA] FALHA OPERACIONAL POR STARVATION: Aviao [%03d] excedeu tempo limite esperando por %s (%lds).\n", 
-                   aviao->ID, nome_recurso, tempo_espera_total);
+            log_evento(LOG_ALERTA, NIVEL_ERRO, "[ALERTA] FALHA OPERACIONAL POR STARVATION: Aviao [%03d] excedeu tempo limite esperando por %s (%lds).\n", 
+                   aviao->ID, nome, tempo_espera_total);
+            rastrear(RASTRO_FALHA, aviao, recurso_rastreado, (int)tempo_espera_total);
             return -1;
         }
+        pthread_mutex_unlock(&fila->mutex);
+        
+        if (tempo_espera_total >= config.limiar_bonus && !no->bonus_aplicado) {
+            if (no->recursos != 0) conjunto_aplicar_bonus(aviao);
+            else fila_aplicar_bonus_no(fila, no);
+        }
         
         if (tempo_espera_total >= ALERTA_CRITICO && !aviao->em_alerta) {
             pthread_mutex_lock(&mutex_lista_avioes);
             aviao->em_alerta = true;
             pthread_mutex_unlock(&mutex_lista_avioes);
             
-            log_message("[ALERTA] Aviao [%03d] em situacao critica esperando por %s (tempo: %lds).\n", 
-                   aviao->ID, nome_recurso, tempo_espera_total);
+            log_evento(LOG_ALERTA, NIVEL_AVISO, "[ALERTA] Aviao [%03d] em situacao critica esperando por %s (tempo: %lds).\n", 
+                   aviao->ID, nome, tempo_espera_total);
+            rastrear(RASTRO_ALERTA, aviao, recurso_rastreado, (int)tempo_espera_total);
         }
+        pthread_mutex_lock(&fila->mutex);
     }
+    pthread_mutex_unlock(&fila->mutex);
+    return 0;
+}
+
+int solicitar_recurso_com_prioridade(recurso_t* recurso, aviao_t* aviao) {
+    tipo_recurso tipo = recurso->tipo;
+    const char* nome_recurso = nome_do_recurso(tipo);
+
+    log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] solicitou %s.\n", aviao->ID, nome_recurso);
+    rastrear(RASTRO_PEDIDO, aviao, tipo, 0);
     
-    while (1) {
-        struct timespec ts;
-        clock_gettime(CLOCK_REALTIME, &ts);
-        ts.tv_sec += 5;
-        
-        if (sem_timedwait(sem_recurso, &ts) == 0) {
-            remover_requisicao(fila, aviao);
-            limpar_requisicao(aviao, tipo);
-            registrar_alocacao(aviao, tipo);
-            log_message("[RECURSO] Aviao [%03d] alocou %s com sucesso.\n", aviao->ID, nome_recurso);
-            return 0;
-        }
-        
-        time_t tempo_espera_total = time(NULL) - tempo_inicio_espera;
-        
-        if (tempo_espera_total >= FALHA) {
-            pthread_mutex_lock(&mutex_lista_avioes);
-            aviao->estado = FALHA_OPERACIONAL;
-            pthread_mutex_unlock(&mutex_lista_avioes);
-            
-            pthread_mutex_lock(&mutex_contadores);
-            contador_starvation++;
-            pthread_mutex_unlock(&mutex_contadores);
-            
-            remover_requisicao(fila, aviao);
-            limpar_requisicao(aviao, tipo);
-            
-            log_message("[ALERTA] FALHA OPERACIONAL POR STARVATION: Aviao [%03d] excedeu tempo limite esperando por %s (%lds).\n", 
-                   aviao->ID, nome_recurso, tempo_espera_total);
-            return -1;
-        }
+    if (aviao->recursos_realocados && aviao->tipo == DOMESTICO) {
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Aviao [%03d] (domestico realocado) tem prioridade maxima.\n",
+               aviao->ID);
+    }
+    
+    registrar_requisicao(aviao, tipo);
+    adicionar_aviao_warning(aviao);
+    
+    int resultado = recurso_solicitar(recurso, aviao);
+    if (resultado == 0) {
+        resultado = aguardar_concessao(recurso->fila, &aviao->requisicoes[tipo], nome_recurso,
+                                       &recurso->latencias, &recurso->latencia_total);
+    }
+    if (resultado < 0) {
+        limpar_requisicao(aviao, tipo);
+        return resultado;
     }
+    
+    limpar_requisicao(aviao, tipo);
+    registrar_alocacao(aviao, tipo);
+    log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] alocou %s com sucesso.\n", aviao->ID, nome_recurso);
+    rastrear(RASTRO_CONCESSAO, aviao, tipo, 0);
+    return 0;
 }
 
-void liberar_recurso_com_prioridade(fila_prioridade_t* fila, sem_t* sem_recurso, aviao_t* aviao, const char* nome_recurso) {
-    log_message("[RECURSO] Aviao [%03d] liberou %s.\n", aviao->ID, nome_recurso);
-    sem_post(sem_recurso);
+// Todos os recursos da operacao em um unico pedido (--aquisicao=conjunto).
+int solicitar_conjunto_com_prioridade(aviao_t* aviao, tipo_operacao operacao) {
+    int recursos = CONJUNTO_OPERACAO[operacao];
+
+    log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] solicitou %s.\n",
+           aviao->ID, RECURSOS_OPERACAO[operacao]);
     
-    pthread_mutex_lock(&fila->mutex);
-    if (fila->head != NULL) {
-        pthread_cond_signal(&fila->head->cond_var);
+    if (aviao->recursos_realocados && aviao->tipo == DOMESTICO) {
+        log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Aviao [%03d] (domestico realocado) tem prioridade maxima.\n",
+               aviao->ID);
     }
-    pthread_mutex_unlock(&fila->mutex);
+    
+    for (int r = 0; r < 3; r++) {
+        if (!(recursos & (1 << r))) continue;
+        registrar_requisicao(aviao, (tipo_recurso)r);
+        rastrear(RASTRO_PEDIDO, aviao, r, 0);
+    }
+    adicionar_aviao_warning(aviao);
+    
+    int resultado = conjunto_solicitar(aviao, recursos);
+    bool obtido = resultado == 1 ||
+                  (resultado == 0 && aguardar_concessao(&conjuntos.fila, &aviao->pedido_conjunto,
+                                                        RECURSOS_OPERACAO[operacao], &conjuntos.latencias,
+                                                        &conjuntos.latencia_total) == 0);
+    
+    for (int r = 0; r < 3; r++) {
+        if (!(recursos & (1 << r))) continue;
+        limpar_requisicao(aviao, (tipo_recurso)r);
+        if (obtido) {
+            registrar_alocacao(aviao, (tipo_recurso)r);
+            log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] alocou %s com sucesso.\n",
+                   aviao->ID, nome_do_recurso((tipo_recurso)r));
+            rastrear(RASTRO_CONCESSAO, aviao, r, 0);
+        }
+    }
+    return obtido ? 0 : -1;
+}
+
+void liberar_recurso_com_prioridade(recurso_t* recurso, aviao_t* aviao) {
+    log_evento(LOG_RECURSO, NIVEL_DETALHE, "[RECURSO] Aviao [%03d] liberou %s.\n",
+           aviao->ID, nome_do_recurso(recurso->tipo));
+    rastrear(RASTRO_LIBERACAO, aviao, recurso->tipo, 0);
+    banqueiro_liberar(aviao, recurso->tipo);
+    if (!repassar_ao_herdeiro(recurso, aviao)) recurso_devolver(recurso);
+}
+
+static int solicitar_do_tipo(aviao_t *aviao, tipo_recurso recurso) {
+    return solicitar_recurso_com_prioridade(recurso_do_tipo(recurso), aviao);
+}
+static void liberar_do_tipo(aviao_t *aviao, tipo_recurso recurso) {
+    registrar_liberacao(aviao, recurso);
+    liberar_recurso_com_prioridade(recurso_do_tipo(recurso), aviao);
 }
 
 int solicitar_pista(aviao_t *aviao) {
-    return solicitar_recurso_com_prioridade(&fila_pistas, &sem_pistas, aviao, RECURSO_PISTA, "PISTA");
+    return solicitar_do_tipo(aviao, RECURSO_PISTA);
 }
 void liberar_pista(aviao_t *aviao) {
-    registrar_liberacao(aviao, RECURSO_PISTA);
-    liberar_recurso_com_prioridade(&fila_pistas, &sem_pistas, aviao, "PISTA");
+    liberar_do_tipo(aviao, RECURSO_PISTA);
 }
 int solicitar_portao(aviao_t *aviao) {
-    return solicitar_recurso_com_prioridade(&fila_portoes, &sem_portoes, aviao, RECURSO_PORTAO, "PORTAO");
+    return solicitar_do_tipo(aviao, RECURSO_PORTAO);
 }
 void liberar_portao(aviao_t *aviao) {
-    registrar_liberacao(aviao, RECURSO_PORTAO);
-    liberar_recurso_com_prioridade(&fila_portoes, &sem_portoes, aviao, "PORTAO");
+    liberar_do_tipo(aviao, RECURSO_PORTAO);
 }
 int solicitar_torre(aviao_t *aviao) {
-    return solicitar_recurso_com_prioridade(&fila_torre_ops, &sem_torre_ops, aviao, RECURSO_TORRE, "TORRE DE CONTROLE");
+    return solicitar_do_tipo(aviao, RECURSO_TORRE);
 }
 void liberar_torre(aviao_t *aviao) {
-    registrar_liberacao(aviao, RECURSO_TORRE);
-    liberar_recurso_com_prioridade(&fila_torre_ops, &sem_torre_ops, aviao, "TORRE DE CONTROLE");
+    liberar_do_tipo(aviao, RECURSO_TORRE);
 }
 
-// Funções de operações complexas
-int solicitar_pouso(aviao_t *aviao) {
-    if (aviao->tipo == DOMESTICO) {
-        if (solicitar_torre(aviao) == -1) return -1;
-        if (solicitar_pista(aviao) == -1) { liberar_torre(aviao); return -1; }
+// Funções de operações complexas: os recursos da operacao um a um, na ordem
+// de ORDEM_RECURSOS para a rota do aviao, ou todos em um pedido de conjunto.
+// Se um passo falha, o que ja foi obtido e devolvido; na preempcao o aviao
+// tambem devolve tudo, mas recomeca a operacao do primeiro passo.
+static int solicitar_operacao(aviao_t *aviao, tipo_operacao operacao) {
+    if (config.aquisicao == AQUISICAO_CONJUNTO) {
+        if (solicitar_conjunto_com_prioridade(aviao, operacao) == -1) return -1;
     } else {
-        if (solicitar_pista(aviao) == -1) return -1;
-        if (solicitar_torre(aviao) == -1) { liberar_pista(aviao); return -1; }
+        const tipo_recurso* passos = ORDEM_RECURSOS[operacao][aviao->rota];
+        banqueiro_declarar(aviao, CONJUNTO_OPERACAO[operacao]);
+        for (int passo = 0; passo < NUM_PASSOS_OPERACAO[operacao]; passo++) {
+            int resultado = solicitar_do_tipo(aviao, passos[passo]);
+            if (resultado == 0) continue;
+            while (--passo >= 0) liberar_do_tipo(aviao, passos[passo]);
+            if (resultado == -1) {
+                banqueiro_encerrar(aviao);
+                return -1;
+            }
+            // passo termina em -1: o laco recomeca do primeiro.
+            aviao_preemptado(aviao, operacao);
+        }
     }
-    log_message("[AVIAO %03d] Obteve todos os recursos para POUSO (Pista + Torre).\n", aviao->ID);
+    log_evento(LOG_AVIAO, NIVEL_INFO, "[AVIAO %03d] Obteve todos os recursos para %s.\n",
+           aviao->ID, RECURSOS_OPERACAO[operacao]);
     return 0;
 }
+
+int solicitar_pouso(aviao_t *aviao) {
+    return solicitar_operacao(aviao, OP_POUSO);
+}
 void liberar_pouso(aviao_t *aviao) {
     liberar_pista(aviao);
     liberar_torre(aviao);
 }
 int solicitar_desembarque(aviao_t *aviao) {
-    if (aviao->tipo == DOMESTICO) {
-        if (solicitar_torre(aviao) == -1) return -1;
-        if (solicitar_portao(aviao) == -1) { liberar_torre(aviao); return -1; }
-    } else {
-        if (solicitar_portao(aviao) == -1) return -1;
-        if (solicitar_torre(aviao) == -1) { liberar_portao(aviao); return -1; }
-    }
-    log_message("[AVIAO %03d] Obteve todos os recursos para DESEMBARQUE (Portao + Torre).\n", aviao->ID);
-    return 0;
+    return solicitar_operacao(aviao, OP_DESEMBARQUE);
 }
 void liberar_desembarque(aviao_t *aviao) {
     liberar_torre(aviao);
-    sleep(2);
+    relogio_dormir(2);
     liberar_portao(aviao);
 }
 int solicitar_decolagem(aviao_t *aviao) {
-    if (aviao->tipo == DOMESTICO) {
-        if (solicitar_torre(aviao) == -1) return -1;
-        if (solicitar_portao(aviao) == -1) { liberar_torre(aviao); return -1; }
-        if (solicitar_pista(aviao) == -1) { liberar_torre(aviao); liberar_portao(aviao); return -1; }
-    } else {
-        if (solicitar_portao(aviao) == -1) return -1;
-        if (solicitar_pista(aviao) == -1) { liberar_portao(aviao); return -1; }
-        if (solicitar_torre(aviao) == -1) { liberar_pista(aviao); liberar_portao(aviao); return -1; }
-    }
-    log_message("[AVIAO %03d] Obteve todos os recursos para DECOLAGEM (Portao + Pista + Torre).\n", aviao->ID);
-    return 0;
+    return solicitar_operacao(aviao, OP_DECOLAGEM);
 }
 void liberar_decolagem(aviao_t *aviao) {
     liberar_portao(aviao);
     liberar_pista(aviao);
     liberar_torre(aviao);
-}
\ No newline at end of file
+}
@@ -0,0 +1,125 @@
+#include "aeroporto.h"
+
+// ------------------------- REGISTRO DE AVIOES -------------------------
+// Os registros vivem em blocos de AVIOES_POR_BLOCO alocados sob demanda. O
+// diretorio de blocos tem tamanho fixo, entao slot -> registro e uma conta e
+// nenhum registro muda de endereco. Slots de avioes que terminaram voltam
+// para uma pilha de livres e sao reaproveitados pelos proximos.
+
+#define AVIOES_POR_BLOCO 1024
+#define MAX_BLOCOS 65536
+
+static char* blocos[MAX_BLOCOS];
+static int num_blocos = 0;
+static size_t tamanho_registro = sizeof(aviao_t);
+
+static int* slots_livres = NULL;
+static int num_livres = 0;
+static int capacidade_livres = 0;
+
+static int avioes_no_registro = 0;
+static int pico_avioes = 0;
+static pthread_mutex_t mutex_registro = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond_registro_vazio = PTHREAD_COND_INITIALIZER;
+
+void registro_iniciar(size_t tamanho) {
+    tamanho_registro = tamanho < sizeof(aviao_t) ? sizeof(aviao_t) : tamanho;
+}
+
+static int novo_bloco() {
+    if (num_blocos == MAX_BLOCOS) return -1;
+
+    char* bloco = calloc(AVIOES_POR_BLOCO, tamanho_registro);
+    if (bloco == NULL) return -1;
+    alocacoes_heap++;
+
+    int primeiro = num_blocos * AVIOES_POR_BLOCO;
+    detector_garantir_capacidade(primeiro + AVIOES_POR_BLOCO);
+
+    // A pilha de livres precisa caber todos os slots, ocupados ou nao.
+    if (capacidade_livres < primeiro + AVIOES_POR_BLOCO) {
+        int nova = primeiro + AVIOES_POR_BLOCO;
+        int* livres = realloc(slots_livres, nova * sizeof(int));
+        if (livres == NULL) {
+            free(bloco);
+            return -1;
+        }
+        slots_livres = livres;
+        capacidade_livres = nova;
+        alocacoes_heap++;
+    }
+
+    for (int i = AVIOES_POR_BLOCO - 1; i >= 0; i--) {
+        aviao_t* aviao = (aviao_t*)(bloco + (size_t)i * tamanho_registro);
+        aviao->slot = primeiro + i;
+        aviao_preparar_registro(aviao);
+        slots_livres[num_livres++] = primeiro + i;
+    }
+    blocos[num_blocos++] = bloco;
+    return 0;
+}
+
+aviao_t* registro_aviao(int slot) {
+    return (aviao_t*)(blocos[slot / AVIOES_POR_BLOCO] + (size_t)(slot % AVIOES_POR_BLOCO) * tamanho_registro);
+}
+
+// Registro zerado no primeiro uso; reaproveitado, mantem o que o motor deixou
+// (tickets de espera, por exemplo) para que prazos antigos continuem reconheciveis.
+aviao_t* registro_obter() {
+    pthread_mutex_lock(&mutex_registro);
+    if (num_livres == 0 && novo_bloco() == -1) {
+        pthread_mutex_unlock(&mutex_registro);
+        return NULL;
+    }
+    int slot = slots_livres[--num_livres];
+    avioes_no_registro++;
+    if (avioes_no_registro > pico_avioes) pico_avioes = avioes_no_registro;
+    pthread_mutex_unlock(&mutex_registro);
+
+    return registro_aviao(slot);
+}
+
+void registro_liberar(aviao_t* aviao) {
+    detector_esquecer_aviao(aviao);
+    remover_aviao_warning(aviao);
+
+    pthread_mutex_lock(&mutex_registro);
+    slots_livres[num_livres++] = aviao->slot;
+    avioes_no_registro--;
+    if (avioes_no_registro == 0) {
+        pthread_cond_broadcast(&cond_registro_vazio);
+    }
+    pthread_mutex_unlock(&mutex_registro);
+}
+
+int registro_capacidade() {
+    pthread_mutex_lock(&mutex_registro);
+    int capacidade = num_blocos * AVIOES_POR_BLOCO;
+    pthread_mutex_unlock(&mutex_registro);
+    return capacidade;
+}
+
+void registro_aguardar_vazio() {
+    pthread_mutex_lock(&mutex_registro);
+    while (avioes_no_registro > 0) {
+        pthread_cond_wait(&cond_registro_vazio, &mutex_registro);
+    }
+    pthread_mutex_unlock(&mutex_registro);
+}
+
+void registro_destruir() {
+    log_evento(LOG_SISTEMA, NIVEL_INFO, "[SISTEMA] Registro de avioes: pico de %d simultaneos em %d slots (%d blocos de %d).\n",
+           pico_avioes, num_blocos * AVIOES_POR_BLOCO, num_blocos, AVIOES_POR_BLOCO);
+
+    for (int i = 0; i < num_blocos; i++) {
+        for (int j = 0; j < AVIOES_POR_BLOCO; j++) {
+            aviao_descartar_registro((aviao_t*)(blocos[i] + (size_t)j * tamanho_registro));
+        }
+        free(blocos[i]);
+        blocos[i] = NULL;
+    }
+    num_blocos = 0;
+    free(slots_livres);
+    slots_livres = NULL;
+    num_livres = capacidade_livres = 0;
+}
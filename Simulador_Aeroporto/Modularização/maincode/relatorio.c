@@ -1,74 +1,121 @@
 #include "aeroporto.h"
 
-void exibir_relatorio_final(aviao_t* avioes[], int total_avioes) {
+// Os registros dos avioes sao reaproveitados, entao o relatorio acumula cada
+// aviao no momento em que ele termina. A tabela por aviao guarda so as
+// primeiras linhas; as estatisticas cobrem todos.
+#define MAX_LINHAS_RELATORIO 200
+
+typedef struct {
+    int ID;
+    tipo_de_voo tipo;
+    estado_aviao estado;
+    long tempo_vida;
+    bool em_alerta;
+} linha_relatorio_t;
+
+static linha_relatorio_t linhas[MAX_LINHAS_RELATORIO];
+static int num_linhas = 0;
+static int total_avioes = 0;
+static int sucessos = 0, falhas = 0;
+static int total_classe[NUM_CLASSES_VOO];
+static int sucessos_classe[NUM_CLASSES_VOO];
+static int falhas_classe[NUM_CLASSES_VOO];
+static double vida_classe[NUM_CLASSES_VOO];
+static pthread_mutex_t mutex_relatorio = PTHREAD_MUTEX_INITIALIZER;
+
+void relatorio_registrar_aviao(aviao_t* aviao) {
+    double vida = relogio_agora() - aviao->tempo_de_criacao;
+    long tempo_vida = (long)vida;
+
+    pthread_mutex_lock(&mutex_relatorio);
+    total_avioes++;
+    total_classe[aviao->tipo]++;
+    vida_classe[aviao->tipo] += vida;
+
+    if (aviao->estado == CONCLUIDO) {
+        sucessos++;
+        sucessos_classe[aviao->tipo]++;
+    } else {
+        falhas++;
+        falhas_classe[aviao->tipo]++;
+    }
+
+    if (num_linhas < MAX_LINHAS_RELATORIO) {
+        linha_relatorio_t* linha = &linhas[num_linhas++];
+        linha->ID = aviao->ID;
+        linha->tipo = aviao->tipo;
+        linha->estado = aviao->estado;
+        linha->tempo_vida = tempo_vida;
+        linha->em_alerta = aviao->em_alerta;
+    }
+    pthread_mutex_unlock(&mutex_relatorio);
+}
+
+static int comparar_linhas(const void* a, const void* b) {
+    return ((const linha_relatorio_t*)a)->ID - ((const linha_relatorio_t*)b)->ID;
+}
+
+void exibir_relatorio_final() {
     printf("\n\n");
     printf("===================================================================================\n");
     printf("                             RELATORIO FINAL DA SIMULACAO\n");
     printf("===================================================================================\n\n");
-    
-    int sucessos = 0, falhas = 0;
-    int internacionais = 0, domesticos = 0;
-    int internacionais_sucesso = 0, domesticos_sucesso = 0;
-    int internacionais_falha = 0, domesticos_falha = 0;
-    
+
     printf(">> Resumo por Aviao:\n");
     printf("-----------------------------------------------------------------------------------\n");
     printf("| ID  | Tipo          | Estado Final           | Tempo de Vida (s) | Alerta Emitido |\n");
     printf("-----------------------------------------------------------------------------------\n");
-    
-    time_t tempo_atual = time(NULL);
-    
-    for (int i = 0; i < total_avioes; i++) {
-        aviao_t* aviao = avioes[i];
-        
-        const char* tipo_str = (aviao->tipo == INTERNACIONAL) ? "Internacional" : "Domestico    ";
+
+    qsort(linhas, num_linhas, sizeof(linha_relatorio_t), comparar_linhas);
+
+    for (int i = 0; i < num_linhas; i++) {
+        linha_relatorio_t* linha = &linhas[i];
+
         const char* estado_str;
-        
-        if (aviao->tipo == INTERNACIONAL) internacionais++; else domesticos++;
-        
-        switch (aviao->estado) {
+
+        switch (linha->estado) {
             case CONCLUIDO:
                 estado_str = "Sucesso              ";
-                sucessos++;
-                if (aviao->tipo == INTERNACIONAL) internacionais_sucesso++; else domesticos_sucesso++;
                 break;
             case FALHA_OPERACIONAL:
                 estado_str = "Falha Operacional    ";
-                falhas++;
-                if (aviao->tipo == INTERNACIONAL) internacionais_falha++; else domesticos_falha++;
                 break;
             default:
                 estado_str = "Interrompido         ";
-                falhas++;
-                if (aviao->tipo == INTERNACIONAL) internacionais_falha++; else domesticos_falha++;
                 break;
         }
-        
-        time_t tempo_vida = tempo_atual - aviao->tempo_de_criacao;
-        
-        printf("| %03d | %s | %s | %-17ld | %-14s |\n",
-               aviao->ID, tipo_str, estado_str, tempo_vida, aviao->em_alerta ? "Sim" : "Nao");
+
+        printf("| %03d | %-13s | %s | %-17ld | %-14s |\n",
+               linha->ID, classes_voo[linha->tipo].nome, estado_str, linha->tempo_vida, linha->em_alerta ? "Sim" : "Nao");
     }
-    
+    if (total_avioes > num_linhas) {
+        printf("| ... | %d avioes omitidos da tabela (contabilizados nas estatisticas)           |\n",
+               total_avioes - num_linhas);
+    }
+
     printf("-----------------------------------------------------------------------------------\n\n");
-    
+
     printf(">> Estatisticas Gerais:\n");
     printf("   - Total de Avioes: %d | Sucessos: %d (%.1f%%) | Falhas: %d (%.1f%%)\n\n", total_avioes,
            sucessos, total_avioes > 0 ? (float)sucessos * 100 / total_avioes : 0,
            falhas, total_avioes > 0 ? (float)falhas * 100 / total_avioes : 0);
 
-    printf("   - Voos Internacionais: Total: %d | Sucessos: %d (%.1f%%) | Falhas: %d (%.1f%%)\n",
-           internacionais, internacionais_sucesso, internacionais > 0 ? (float)internacionais_sucesso * 100 / internacionais : 0,
-           internacionais_falha, internacionais > 0 ? (float)internacionais_falha * 100 / internacionais : 0);
-           
-    printf("   - Voos Domesticos:     Total: %d | Sucessos: %d (%.1f%%) | Falhas: %d (%.1f%%)\n\n",
-           domesticos, domesticos_sucesso, domesticos > 0 ? (float)domesticos_sucesso * 100 / domesticos : 0,
-           domesticos_falha, domesticos > 0 ? (float)domesticos_falha * 100 / domesticos : 0);
+    printf(">> Estatisticas por Classe de Voo:\n");
+    for (int i = 0; i < NUM_CLASSES_VOO; i++) {
+        int total = total_classe[i];
+        if (total == 0) continue;
+        printf("   - %-13s Total: %d | Sucessos: %d (%.1f%%) | Falhas: %d (%.1f%%) | Vida media: %.1fs\n",
+               classes_voo[i].nome, total,
+               sucessos_classe[i], (float)sucessos_classe[i] * 100 / total,
+               falhas_classe[i], (float)falhas_classe[i] * 100 / total,
+               vida_classe[i] / total);
+    }
+    printf("\n");
 
     printf(">> Problemas Detectados:\n");
     printf("   - Deadlocks: %d\n   - Falhas por Starvation: %d\n   - Recursos Realocados: %d\n\n",
            contador_deadlocks, contador_starvation, recursos_realocados);
-    
+
     printf(">> Configuracao da Simulacao:\n");
     printf("   - Pistas: %d | Portoes: %d | Ops. Torre: %d | Tempo Total: %ds\n",
            NUM_PISTAS, NUM_PORTOES, NUM_OP_TORRES, TEMPO_TOTAL);
@@ -76,4 +123,4 @@ void exibir_relatorio_final(aviao_t* avioes[], int total_avioes) {
     printf("\n===================================================================================\n");
     printf("                                FIM DA SIMULACAO\n");
     printf("===================================================================================\n");
-}
\ No newline at end of file
+}
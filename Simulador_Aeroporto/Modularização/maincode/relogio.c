@@ -0,0 +1,89 @@
+#include "relogio.h"
+#include "fibra.h"
+#include <errno.h>
+
+static bool modo_virtual = false;
+static double escala_tempo = 1.0;
+static double tempo_virtual = 0.0;
+static double inicio_real = 0.0;
+static time_t inicio_data = 0;
+
+double relogio_real() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void relogio_iniciar(bool virtual, double escala) {
+    modo_virtual = virtual;
+    escala_tempo = escala > 0 ? escala : 1.0;
+    tempo_virtual = 0.0;
+    inicio_real = relogio_real();
+    inicio_data = time(NULL);
+}
+
+double relogio_agora() {
+    if (modo_virtual) {
+        return tempo_virtual;
+    }
+    return (relogio_real() - inicio_real) * escala_tempo;
+}
+
+// Data "de parede" correspondente ao instante simulado atual, usada no log.
+time_t relogio_data() {
+    return inicio_data + (time_t)relogio_agora();
+}
+
+// A mesma data pelo relogio grosso do kernel (alguns ms de resolucao), que
+// custa uma fracao do CLOCK_MONOTONIC: basta para os segundos do log.
+time_t relogio_data_grossa() {
+    if (modo_virtual) {
+        return inicio_data + (time_t)tempo_virtual;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return inicio_data + (time_t)((ts.tv_sec + ts.tv_nsec / 1e9 - inicio_real) * escala_tempo);
+}
+
+void relogio_avancar(double instante) {
+    tempo_virtual = instante;
+}
+
+void relogio_dormir(double segundos) {
+    if (segundos <= 0) return;
+
+    if (fibra_atual() != NULL) {
+        struct timespec prazo;
+        relogio_prazo(segundos, &prazo);
+        fibra_dormir(&prazo);
+        return;
+    }
+
+    double real = segundos / escala_tempo;
+    struct timespec ts;
+    ts.tv_sec = (time_t)real;
+    ts.tv_nsec = (long)((real - ts.tv_sec) * 1e9);
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {
+    }
+}
+
+// Prazo absoluto em CLOCK_MONOTONIC para daqui a "segundos" simulados, no
+// formato que pthread_cond_timedwait espera.
+void relogio_prazo(double segundos, struct timespec* ts) {
+    double real = segundos / escala_tempo;
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += (time_t)real;
+    ts->tv_nsec += (long)((real - (time_t)real) * 1e9);
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+void relogio_iniciar_cond(pthread_cond_t* cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
@@ -0,0 +1,319 @@
+#include "skiplist.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MARCA 1UL
+#define TORRES_POR_BLOCO 64
+#define LIMITE_APOSENTADAS 64
+
+static torre_t* ponteiro(uintptr_t valor) {
+    return (torre_t*)(valor & ~MARCA);
+}
+
+static bool marcado(uintptr_t valor) {
+    return (valor & MARCA) != 0;
+}
+
+// ------------------------- RECLAMACAO POR EPOCAS -------------------------
+// Cada thread que usa a lista tem um participante. Dentro de uma operacao ele
+// fica ativo e anuncia a epoca global que viu; a epoca so avanca quando todos
+// os ativos ja a viram. Uma torre aposentada na epoca e pode ser reusada
+// quando a epoca global chega a e + 2: ninguem que a viu ligada ainda esta
+// dentro de uma operacao. Participantes de threads encerradas sao adotados
+// por threads novas, com as torres que deixaram.
+
+typedef struct participante {
+    _Atomic unsigned long epoca;
+    _Atomic bool ativo;
+    _Atomic bool em_uso;
+    torre_t* livres;
+    torre_t* aposentadas;           // FIFO: as mais antigas primeiro
+    torre_t* fim_aposentadas;
+    int num_aposentadas;
+    unsigned int semente;
+    struct participante* proximo;
+} participante_t;
+
+typedef struct bloco_torres {
+    struct bloco_torres* proximo;
+    torre_t torres[TORRES_POR_BLOCO];
+} bloco_torres_t;
+
+static _Atomic(participante_t*) participantes = NULL;
+static _Atomic(bloco_torres_t*) blocos = NULL;
+static _Atomic unsigned long epoca_global = 0;
+static _Atomic unsigned int proxima_semente = 1;
+static pthread_key_t chave_participante;
+static pthread_once_t chave_criada = PTHREAD_ONCE_INIT;
+static __thread participante_t* participante_atual = NULL;
+
+static void liberar_participante(void* p) {
+    atomic_store(&((participante_t*)p)->em_uso, false);
+}
+
+static void criar_chave() {
+    pthread_key_create(&chave_participante, liberar_participante);
+}
+
+static participante_t* obter_participante() {
+    if (participante_atual != NULL) return participante_atual;
+    pthread_once(&chave_criada, criar_chave);
+
+    participante_t* p = atomic_load(&participantes);
+    for (; p != NULL; p = p->proximo) {
+        bool livre = false;
+        if (atomic_compare_exchange_strong(&p->em_uso, &livre, true)) break;
+    }
+    if (p == NULL) {
+        p = calloc(1, sizeof(participante_t));
+        if (p == NULL) {
+            perror("Falha ao alocar participante da skiplist");
+            exit(EXIT_FAILURE);
+        }
+        atomic_init(&p->em_uso, true);
+        p->semente = atomic_fetch_add(&proxima_semente, 0x9e3779b9u) | 1u;
+        p->proximo = atomic_load(&participantes);
+        while (!atomic_compare_exchange_weak(&participantes, &p->proximo, p)) {
+        }
+    }
+    pthread_setspecific(chave_participante, p);
+    participante_atual = p;
+    return p;
+}
+
+static participante_t* entrar() {
+    participante_t* p = obter_participante();
+    atomic_store(&p->ativo, true);
+    atomic_store(&p->epoca, atomic_load(&epoca_global));
+    return p;
+}
+
+static void sair(participante_t* p) {
+    atomic_store_explicit(&p->ativo, false, memory_order_release);
+}
+
+static void tentar_avancar_epoca() {
+    unsigned long epoca = atomic_load(&epoca_global);
+    for (participante_t* p = atomic_load(&participantes); p != NULL; p = p->proximo) {
+        if (atomic_load(&p->ativo) && atomic_load(&p->epoca) != epoca) return;
+    }
+    atomic_compare_exchange_strong(&epoca_global, &epoca, epoca + 1);
+}
+
+static void recolher(participante_t* p) {
+    unsigned long epoca = atomic_load(&epoca_global);
+    while (p->aposentadas != NULL && p->aposentadas->epoca + 2 <= epoca) {
+        torre_t* t = p->aposentadas;
+        p->aposentadas = t->livre;
+        if (p->aposentadas == NULL) p->fim_aposentadas = NULL;
+        p->num_aposentadas--;
+        t->livre = p->livres;
+        p->livres = t;
+    }
+}
+
+static void aposentar(participante_t* p, torre_t* t) {
+    t->epoca = atomic_load(&epoca_global);
+    t->livre = NULL;
+    if (p->fim_aposentadas) p->fim_aposentadas->livre = t; else p->aposentadas = t;
+    p->fim_aposentadas = t;
+    if (++p->num_aposentadas >= LIMITE_APOSENTADAS) {
+        tentar_avancar_epoca();
+        recolher(p);
+    }
+}
+
+static torre_t* nova_torre(participante_t* p) {
+    if (p->livres == NULL) {
+        recolher(p);
+    }
+    if (p->livres == NULL) {
+        bloco_torres_t* bloco = malloc(sizeof(bloco_torres_t));
+        if (bloco == NULL) {
+            perror("Falha ao alocar torres da skiplist");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < TORRES_POR_BLOCO; i++) {
+            bloco->torres[i].livre = p->livres;
+            p->livres = &bloco->torres[i];
+        }
+        bloco->proximo = atomic_load(&blocos);
+        while (!atomic_compare_exchange_weak(&blocos, &bloco->proximo, bloco)) {
+        }
+    }
+    torre_t* t = p->livres;
+    p->livres = t->livre;
+    return t;
+}
+
+// Altura geometrica (metade das torres sobe cada nivel), por xorshift.
+static int sortear_altura(participante_t* p) {
+    unsigned int x = p->semente;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    p->semente = x;
+    return 1 + __builtin_ctz(x | (1u << (NIVEIS_SKIPLIST - 1)));
+}
+
+// ------------------------------- LISTA -------------------------------
+static bool antes(const torre_t* t, double chave, unsigned long ordem) {
+    if (t->chave != chave) return t->chave > chave;
+    return t->ordem < ordem;
+}
+
+// Antecessores e sucessores de (chave, ordem) em cada nivel. Torres marcadas
+// no caminho sao desligadas; se o antecessor mudou, recomeca do topo.
+static void localizar(skiplist_t* lista, double chave, unsigned long ordem,
+                      torre_t** antecessores, torre_t** sucessores) {
+recomecar:;
+    torre_t* anterior = &lista->cabeca;
+    for (int nivel = NIVEIS_SKIPLIST - 1; nivel >= 0; nivel--) {
+        torre_t* atual = ponteiro(atomic_load(&anterior->proximo[nivel]));
+        while (atual != NULL) {
+            uintptr_t seguinte = atomic_load(&atual->proximo[nivel]);
+            if (marcado(seguinte)) {
+                uintptr_t esperado = (uintptr_t)atual;
+                if (!atomic_compare_exchange_strong(&anterior->proximo[nivel], &esperado, seguinte & ~MARCA)) {
+                    goto recomecar;
+                }
+                atual = ponteiro(seguinte);
+                continue;
+            }
+            if (!antes(atual, chave, ordem)) break;
+            anterior = atual;
+            atual = ponteiro(seguinte);
+        }
+        antecessores[nivel] = anterior;
+        sucessores[nivel] = atual;
+    }
+}
+
+// Marca os niveis de cima e depois o nivel 0; quem marca o nivel 0 ganha a
+// remocao, desliga a torre e a aposenta.
+static bool remover(skiplist_t* lista, participante_t* p, torre_t* t) {
+    for (int nivel = t->altura - 1; nivel >= 1; nivel--) {
+        uintptr_t seguinte = atomic_load(&t->proximo[nivel]);
+        while (!marcado(seguinte) &&
+               !atomic_compare_exchange_weak(&t->proximo[nivel], &seguinte, seguinte | MARCA)) {
+        }
+    }
+
+    uintptr_t seguinte = atomic_load(&t->proximo[0]);
+    while (!marcado(seguinte)) {
+        if (atomic_compare_exchange_weak(&t->proximo[0], &seguinte, seguinte | MARCA)) {
+            torre_t* antecessores[NIVEIS_SKIPLIST];
+            torre_t* sucessores[NIVEIS_SKIPLIST];
+            localizar(lista, t->chave, t->ordem, antecessores, sucessores);
+            aposentar(p, t);
+            return true;
+        }
+    }
+    return false;
+}
+
+// ----------------------------- INTERFACE -----------------------------
+void skiplist_iniciar(skiplist_t* lista) {
+    memset(&lista->cabeca, 0, sizeof(lista->cabeca));
+    lista->cabeca.altura = NIVEIS_SKIPLIST;
+}
+
+void skiplist_inserir(skiplist_t* lista, double chave, unsigned long ordem, void* valor, torre_t** torre) {
+    participante_t* p = entrar();
+    torre_t* antecessores[NIVEIS_SKIPLIST];
+    torre_t* sucessores[NIVEIS_SKIPLIST];
+
+    torre_t* t = nova_torre(p);
+    t->chave = chave;
+    t->ordem = ordem;
+    t->valor = valor;
+    t->altura = sortear_altura(p);
+    *torre = t;
+
+    while (1) {
+        localizar(lista, chave, ordem, antecessores, sucessores);
+        for (int nivel = 0; nivel < t->altura; nivel++) {
+            atomic_store(&t->proximo[nivel], (uintptr_t)sucessores[nivel]);
+        }
+        uintptr_t esperado = (uintptr_t)sucessores[0];
+        if (atomic_compare_exchange_strong(&antecessores[0]->proximo[0], &esperado, (uintptr_t)t)) break;
+    }
+
+    // Niveis de cima: para assim que uma remocao concorrente marca a torre.
+    for (int nivel = 1; nivel < t->altura; nivel++) {
+        while (1) {
+            uintptr_t meu = atomic_load(&t->proximo[nivel]);
+            if (marcado(meu)) goto ligada;
+            if (ponteiro(meu) != sucessores[nivel] &&
+                !atomic_compare_exchange_strong(&t->proximo[nivel], &meu, (uintptr_t)sucessores[nivel])) {
+                goto ligada;
+            }
+            uintptr_t esperado = (uintptr_t)sucessores[nivel];
+            if (atomic_compare_exchange_strong(&antecessores[nivel]->proximo[nivel], &esperado, (uintptr_t)t)) break;
+            localizar(lista, chave, ordem, antecessores, sucessores);
+        }
+    }
+ligada:
+    // Uma remocao que terminou antes de algum nivel ser ligado nao o desligou.
+    if (marcado(atomic_load(&t->proximo[0]))) {
+        localizar(lista, chave, ordem, antecessores, sucessores);
+    }
+    sair(p);
+}
+
+bool skiplist_remover(skiplist_t* lista, torre_t* torre) {
+    participante_t* p = entrar();
+    bool removida = remover(lista, p, torre);
+    sair(p);
+    return removida;
+}
+
+void* skiplist_primeiro(skiplist_t* lista) {
+    participante_t* p = entrar();
+    void* valor = NULL;
+    for (torre_t* t = ponteiro(atomic_load(&lista->cabeca.proximo[0])); t != NULL;
+         t = ponteiro(atomic_load(&t->proximo[0]))) {
+        if (!marcado(atomic_load(&t->proximo[0]))) {
+            valor = t->valor;
+            break;
+        }
+    }
+    sair(p);
+    return valor;
+}
+
+// Retirada relaxada do primeiro: disputa o primeiro nao marcado e, se perder,
+// tenta o seguinte, sem voltar ao topo.
+void* skiplist_retirar_primeiro(skiplist_t* lista) {
+    participante_t* p = entrar();
+    void* valor = NULL;
+    torre_t* t = ponteiro(atomic_load(&lista->cabeca.proximo[0]));
+    while (t != NULL) {
+        if (!marcado(atomic_load(&t->proximo[0])) && remover(lista, p, t)) {
+            valor = t->valor;
+            break;
+        }
+        t = ponteiro(atomic_load(&t->proximo[0]));
+    }
+    sair(p);
+    return valor;
+}
+
+// So no encerramento, sem nenhuma thread usando listas.
+void skiplist_liberar_memoria() {
+    bloco_torres_t* bloco = atomic_exchange(&blocos, NULL);
+    while (bloco != NULL) {
+        bloco_torres_t* proximo = bloco->proximo;
+        free(bloco);
+        bloco = proximo;
+    }
+    participante_t* p = atomic_exchange(&participantes, NULL);
+    while (p != NULL) {
+        participante_t* proximo = p->proximo;
+        free(p);
+        p = proximo;
+    }
+    participante_atual = NULL;
+}
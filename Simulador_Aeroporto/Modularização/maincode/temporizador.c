@@ -0,0 +1,181 @@
+#include "temporizador.h"
+#include "relogio.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NOS_POR_BLOCO 256
+
+static unsigned long long tique_de(double prazo) {
+    return prazo <= 0 ? 0 : (unsigned long long)(prazo * 1000.0);
+}
+
+// ------------------------------- NOS -------------------------------
+// Os nos vem de blocos e voltam para a lista de livres: agendar nao chama
+// malloc depois que a agenda atinge seu tamanho de trabalho.
+static no_temporizador_t* obter_no(agenda_t* agenda) {
+    if (agenda->livres == NULL) {
+        void** blocos = realloc(agenda->blocos, (agenda->num_blocos + 1) * sizeof(void*));
+        no_temporizador_t* bloco = malloc(NOS_POR_BLOCO * sizeof(no_temporizador_t));
+        if (blocos == NULL || bloco == NULL) {
+            perror("Falha ao expandir a agenda de temporizadores");
+            exit(EXIT_FAILURE);
+        }
+        agenda->blocos = blocos;
+        agenda->blocos[agenda->num_blocos++] = bloco;
+        for (int i = 0; i < NOS_POR_BLOCO; i++) {
+            bloco[i].proximo = agenda->livres;
+            agenda->livres = &bloco[i];
+        }
+    }
+    no_temporizador_t* no = agenda->livres;
+    agenda->livres = no->proximo;
+    return no;
+}
+
+// ------------------------------- RODA -------------------------------
+// O nivel sai da distancia ate o prazo: o nivel n cobre ate 64^(n+1) tiques
+// a frente. Prazos alem do ultimo nivel ficam na sua ultima posicao e sao
+// recolocados quando ela desce.
+static void colocar(agenda_t* agenda, no_temporizador_t* no) {
+    if (no->tique < agenda->atual) {
+        no->proximo = agenda->vencidos;
+        agenda->vencidos = no;
+        return;
+    }
+
+    unsigned long long distancia = no->tique - agenda->atual;
+    unsigned long long tique = no->tique;
+    int nivel = 0;
+    while (nivel < NIVEIS_RODA - 1 && distancia >= (1ULL << (BITS_POSICAO * (nivel + 1)))) {
+        nivel++;
+    }
+    if (distancia >= (1ULL << (BITS_POSICAO * NIVEIS_RODA))) {
+        tique = agenda->atual + (1ULL << (BITS_POSICAO * NIVEIS_RODA)) - 1;
+    }
+
+    int posicao = (tique >> (BITS_POSICAO * nivel)) & (POSICOES_RODA - 1);
+    no->proximo = agenda->posicoes[nivel][posicao];
+    agenda->posicoes[nivel][posicao] = no;
+    agenda->ocupadas[nivel] |= 1ULL << posicao;
+}
+
+// Esvazia uma posicao de um nivel alto, recolocando cada no pelo seu prazo.
+static void descer(agenda_t* agenda, int nivel, int posicao) {
+    no_temporizador_t* no = agenda->posicoes[nivel][posicao];
+    agenda->posicoes[nivel][posicao] = NULL;
+    agenda->ocupadas[nivel] &= ~(1ULL << posicao);
+
+    while (no != NULL) {
+        no_temporizador_t* proximo = no->proximo;
+        colocar(agenda, no);
+        no = proximo;
+    }
+}
+
+// Processa os tiques ate "alvo" (exclusive): ao virar uma volta de um nivel,
+// a posicao correspondente do nivel de cima desce antes do tique expirar.
+static void avancar(agenda_t* agenda, unsigned long long alvo) {
+    while (agenda->atual < alvo) {
+        if (agenda->pendentes == 0) {
+            agenda->atual = alvo;
+            return;
+        }
+
+        unsigned long long atual = agenda->atual;
+        int posicao = atual & (POSICOES_RODA - 1);
+        if (posicao == 0) {
+            int nivel = 1;
+            while (nivel < NIVEIS_RODA - 1 && ((atual >> (BITS_POSICAO * nivel)) & (POSICOES_RODA - 1)) == 0) {
+                nivel++;
+            }
+            for (; nivel >= 1; nivel--) {
+                descer(agenda, nivel, (atual >> (BITS_POSICAO * nivel)) & (POSICOES_RODA - 1));
+            }
+        }
+
+        no_temporizador_t* no = agenda->posicoes[0][posicao];
+        agenda->posicoes[0][posicao] = NULL;
+        agenda->ocupadas[0] &= ~(1ULL << posicao);
+        while (no != NULL) {
+            no_temporizador_t* proximo = no->proximo;
+            no->proximo = agenda->vencidos;
+            agenda->vencidos = no;
+            no = proximo;
+        }
+        agenda->atual++;
+    }
+}
+
+// ----------------------------- INTERFACE -----------------------------
+// Retorna true quando o prazo cai na primeira volta da roda (os proximos
+// POSICOES_RODA ms), para que o dono da agenda acorde quem estiver dormindo
+// ate um limite posterior.
+bool agenda_inserir(agenda_t* agenda, double prazo, void* alvo, unsigned long marca, int tipo) {
+    // Agenda vazia: o tique atual pode estar muito atrasado.
+    if (agenda->pendentes == 0) {
+        agenda->atual = tique_de(relogio_real());
+    }
+
+    no_temporizador_t* no = obter_no(agenda);
+    no->t = (temporizador_t){ prazo, alvo, marca, tipo };
+    no->tique = tique_de(prazo);
+    colocar(agenda, no);
+    agenda->pendentes++;
+    agenda->inseridos++;
+
+    return no->tique < agenda->atual + POSICOES_RODA;
+}
+
+// Um tique so expira depois de terminar: o disparo atrasa ate 1 ms, nunca
+// adianta.
+bool agenda_retirar_vencido(agenda_t* agenda, double agora, temporizador_t* saida) {
+    if (agenda->vencidos == NULL) {
+        avancar(agenda, tique_de(agora));
+    }
+    no_temporizador_t* no = agenda->vencidos;
+    if (no == NULL) {
+        return false;
+    }
+
+    agenda->vencidos = no->proximo;
+    *saida = no->t;
+    no->proximo = agenda->livres;
+    agenda->livres = no;
+    agenda->pendentes--;
+    agenda->disparados++;
+    return true;
+}
+
+// Limite inferior para o proximo disparo: o fim do proximo tique ocupado da
+// primeira volta ou, sem nenhum, a proxima descida de nivel. No inicio de
+// uma volta a descida ainda nao aconteceu e o proprio tique atual conta.
+bool agenda_proximo_prazo(const agenda_t* agenda, double* prazo) {
+    if (agenda->pendentes == 0) return false;
+    if (agenda->vencidos != NULL) {
+        *prazo = 0;
+        return true;
+    }
+
+    unsigned long long tique;
+    int deslocamento = agenda->atual & (POSICOES_RODA - 1);
+    unsigned long long ocupadas = agenda->ocupadas[0];
+    if (deslocamento == 0) {
+        tique = agenda->atual + 1;
+    } else if (ocupadas != 0) {
+        unsigned long long girado = (ocupadas >> deslocamento) | (ocupadas << (POSICOES_RODA - deslocamento));
+        tique = agenda->atual + __builtin_ctzll(girado) + 1;
+    } else {
+        tique = agenda->atual - deslocamento + POSICOES_RODA + 1;
+    }
+    *prazo = tique / 1000.0;
+    return true;
+}
+
+void agenda_destruir(agenda_t* agenda) {
+    for (size_t i = 0; i < agenda->num_blocos; i++) {
+        free(agenda->blocos[i]);
+    }
+    free(agenda->blocos);
+    memset(agenda, 0, sizeof(*agenda));
+}